@@ -13,15 +13,21 @@
 #include <linux/dma-mapping.h>
 #include <linux/dmaengine.h>
 #include <linux/gpio/consumer.h>
+#include <linux/iopoll.h>
 #include <linux/iio/iio.h>
 #include <linux/iio/buffer.h>
 #include <linux/iio/buffer_impl.h>
 #include <linux/iio/buffer-dma.h>
 #include <linux/iio/buffer-dmaengine.h>
+#include <linux/iio/events.h>
+#include <linux/ktime.h>
 #include <linux/module.h>
+#include <linux/property.h>
 #include <linux/regmap.h>
 #include <linux/regulator/consumer.h>
 #include <linux/spi/spi.h>
+#include <linux/units.h>
+#include <linux/workqueue.h>
 
 #include "cf_axi_adc.h"
 
@@ -55,6 +61,44 @@
 #define ADAQ8092_RAND			BIT(1)
 #define ADAQ8092_TWOSCOMP		BIT(0)
 
+/* AXI ADAQ8092 core data format and interface control */
+#define ADAQ8092_AXI_REG_CNTRL		0x4c
+#define ADAQ8092_AXI_RAND		BIT(0)
+#define ADAQ8092_AXI_ABP		BIT(1)
+#define ADAQ8092_AXI_CMOS_SEL		BIT(2)
+
+/* Registers covered by the configuration image */
+#define ADAQ8092_IMAGE_REGS		4
+
+/* AXI interface realign timeout after a quiesced reconfiguration */
+#define ADAQ8092_REALIGN_TIMEOUT_US	10000
+
+/* Software reset completion polling */
+#define ADAQ8092_RESET_POLL_US		10
+#define ADAQ8092_RESET_TIMEOUT_US	100000
+
+/* SPI clock autotune readback passes per step */
+#define ADAQ8092_SPI_AUTOTUNE_PASSES	16
+
+/* Register readback is only specified up to 4 MHz (tSCK >= 250 ns) */
+#define ADAQ8092_SPI_READ_MAX_HZ	4000000
+#define ADAQ8092_SPI_READ		BIT(7)
+
+/* Default period of the background link monitor, 0 disables it */
+#define ADAQ8092_LINK_MONITOR_MS	1000
+
+/* Default full-scale input span, peak-to-peak */
+#define ADAQ8092_INPUT_RANGE_UV		2000000
+
+/*
+ * AXI core correction limits, the gain coefficient is signed 1.1.14 fixed
+ * point, so the largest scale is 32767 / 16384 and anything that rounds to
+ * 0x8000 would read back as -2.0.
+ */
+#define ADAQ8092_CALIBBIAS_MAX		8191
+#define ADAQ8092_CALIBSCALE_FRAC_BITS	14
+#define ADAQ8092_CALIBSCALE_MAX_MICRO	1999938
+
 /* ADAQ8092 Power Down Modes */
 enum adaq8092_powerdown_modes {
 	ADAQ8092_NORMAL_OP,
@@ -116,8 +160,8 @@ enum adaq8092_dout_modes {
 /* ADAQ8092 Digital Test Pattern */
 enum adaq8092_out_test_modes {
 	ADAQ8092_TEST_OFF = 0,
-	ADAQ8092_TEST_ONES = 1,
-	ADAQ8092_TEST_ZEROS = 3,
+	ADAQ8092_TEST_ZEROS = 1,
+	ADAQ8092_TEST_ONES = 3,
 	ADAQ8092_TEST_CHECKERBOARD = 5,
 	ADAQ8092_TEST_ALTERNATING = 7
 };
@@ -140,6 +184,30 @@ enum adaq8092_twoscomp {
 	ADAQ8092_TWOS_COMPLEMENT
 };
 
+/*
+ * Runtime reconfiguration classes. Hot swappable attributes only change the
+ * sample values and are applied while streaming. Quiesce attributes retime
+ * the data interface, stop it, or change the encoding the AXI core has to
+ * undo, so the AXI data path is held in reset and realigned around the change.
+ */
+enum adaq8092_reconfig_class {
+	ADAQ8092_HOT_SWAP,
+	ADAQ8092_QUIESCE
+};
+
+enum adaq8092_reconfig_attr {
+	ADAQ8092_RECONFIG_COUNT,
+	ADAQ8092_REALIGN_COUNT,
+	ADAQ8092_REALIGN_TIME,
+	ADAQ8092_DOUT_SWITCH_TIME,
+	ADAQ8092_RESET_TIME
+};
+
+enum adaq8092_status_count {
+	ADAQ8092_LINK_ERRORS,
+	ADAQ8092_OVER_RANGE
+};
+
 /* ADAQ8092 Communication Mode */
 enum adaq8092_par_ser {
 	ADAQ8092_SERIAL,
@@ -153,9 +221,17 @@ enum adaq8092_pd_gpio {
 	ADAQ8092_PD1_OFF_PD2_OFF
 };
 
+/* AXI core register accessors, the KUnit tests plug in a fake core */
+struct adaq8092_axi_ops {
+	unsigned int (*read)(struct axiadc_state *st, unsigned int reg);
+	void (*write)(struct axiadc_state *st, unsigned int reg,
+		      unsigned int val);
+};
+
 struct adaq8092_state {
 	struct spi_device		*spi;
 	struct regmap			*regmap;
+	const struct adaq8092_axi_ops	*axi_ops;
 	struct clk			*clkin;
 	/* Protect against concurrent accesses to the device and data content */
 	struct mutex			lock;
@@ -178,6 +254,28 @@ struct adaq8092_state {
 	enum adaq8092_par_ser		par_ser_mode;
 	enum adaq8092_pd_gpio		pd_gpio_mode;
 	unsigned int			sampling_freq;
+	u32				input_range_uv;
+	int				calibbias[2];
+	u32				calibscale[2];
+	struct iio_dev			*indio_dev;
+	struct delayed_work		link_work;
+	u32				link_monitor_ms;
+	bool				pn_monitor;
+	unsigned int			link_errors[2];
+	unsigned int			over_range[2];
+	bool				spi_autotune;
+	bool				reconfig_quiesced;
+	/* Data path left in reset while the outputs are stopped */
+	bool				reconfig_held;
+	ktime_t				reconfig_start;
+	unsigned int			reconfig_count;
+	unsigned int			realign_count;
+	u64				realign_ns;
+	u64				dout_switch_ns;
+	u64				reset_ns;
+	bool				dout_switchable;
+	bool				timing_fixed;
+	u8				spi_buf[2] ____cacheline_aligned;
 };
 
 static const char * const adaq8092_pd_modes[] = {
@@ -232,8 +330,8 @@ static const char * const adaq8092_dout_modes[] = {
 
 static const char * const adaq8092_test_modes[] = {
 	[ADAQ8092_TEST_OFF] = "test_pattern_off",
-	[ADAQ8092_TEST_ONES] = "test_all_digital_zero",
-	[ADAQ8092_TEST_ZEROS] = "test_all_digital_one",
+	[ADAQ8092_TEST_ZEROS] = "test_all_digital_zero",
+	[ADAQ8092_TEST_ONES] = "test_all_digital_one",
 	[ADAQ8092_TEST_CHECKERBOARD] = "test_checkerboard",
 	[ADAQ8092_TEST_ALTERNATING] = "test_alternating"
 };
@@ -265,10 +363,83 @@ static const char * const adaq8092_pd_gpio_mode[] = {
 	[ADAQ8092_PD1_OFF_PD2_OFF] = "pd1_off_pd2_off",
 };
 
+/* Device tree values of the clock phase and LVDS current modes */
+static const u32 adaq8092_clk_phase_deg[] = {
+	[ADAQ8092_NO_DELAY] = 0,
+	[ADAQ8092_CLKOUT_DELAY_45DEG] = 45,
+	[ADAQ8092_CLKOUT_DELAY_90DEG] = 90,
+	[ADAQ8092_CLKOUT_DELAY_180DEG] = 180
+};
+
+static const u32 adaq8092_lvds_cur_ua[] = {
+	[ADAQ8092_3M5A] = 3500,
+	[ADAQ8092_4MA] = 4000,
+	[ADAQ8092_4M5A] = 4500,
+	[ADAQ8092_3MA] = 3000,
+	[ADAQ8092_2M5A] = 2500,
+	[ADAQ8092_2M1A] = 2100,
+	[ADAQ8092_1M75] = 1750,
+};
+
+/* SPI clock steps tried by adaq8092_spi_autotune(), in ascending order */
+static const u32 adaq8092_spi_speeds[] = {
+	1000000, 2000000, 5000000, 10000000, 12500000, 16666666, 20000000,
+	25000000
+};
+
+/*
+ * Readback patterns as {TIMING, OUTTEST}. OUTPUT_MODE is left alone, so the
+ * outputs keep their configured state and no reserved OUTMODE is written.
+ */
+static const u8 adaq8092_spi_patterns[][2] = {
+	{ 0x0A, ADAQ8092_TEST_CHECKERBOARD },
+	{ 0x05, ADAQ8092_TEST_ZEROS },
+	{ 0x0F, ADAQ8092_TEST_ALTERNATING },
+	{ 0x00, ADAQ8092_TEST_OFF },
+};
+
+/* Reads stay within the readback limit, writes run at the autotuned clock */
+static int adaq8092_spi_reg_read(void *context, unsigned int reg,
+				 unsigned int *val)
+{
+	struct adaq8092_state *st = context;
+	struct spi_transfer xfer = {
+		.tx_buf = st->spi_buf,
+		.rx_buf = st->spi_buf,
+		.len = sizeof(st->spi_buf),
+		.speed_hz = min_t(u32, st->spi->max_speed_hz,
+				  ADAQ8092_SPI_READ_MAX_HZ),
+	};
+	int ret;
+
+	st->spi_buf[0] = ADAQ8092_SPI_READ | reg;
+	st->spi_buf[1] = 0;
+
+	ret = spi_sync_transfer(st->spi, &xfer, 1);
+	if (ret)
+		return ret;
+
+	*val = st->spi_buf[1];
+
+	return 0;
+}
+
+static int adaq8092_spi_reg_write(void *context, unsigned int reg,
+				  unsigned int val)
+{
+	struct adaq8092_state *st = context;
+
+	st->spi_buf[0] = reg;
+	st->spi_buf[1] = val;
+
+	return spi_write(st->spi, st->spi_buf, sizeof(st->spi_buf));
+}
+
 static const struct regmap_config adaq8092_regmap_config = {
 	.reg_bits = 8,
 	.val_bits = 8,
-	.read_flag_mask = BIT(7),
+	.reg_read = adaq8092_spi_reg_read,
+	.reg_write = adaq8092_spi_reg_write,
 	.max_register = 0x1A,
 };
 
@@ -281,67 +452,140 @@ static struct adaq8092_state *adaq8092_get_data(struct iio_dev *indio_dev)
 	return conv->phy;
 }
 
+/* Sleep, nap of both channels, OUTOFF and the PD pins stop the data and DCO */
+static bool adaq8092_dout_stopped(struct adaq8092_state *st)
+{
+	return st->pd_mode == ADAQ8092_CH1_CH2_NAP ||
+	       st->pd_mode == ADAQ8092_SLEEP ||
+	       st->dout_en == ADAQ8092_DOUT_OFF ||
+	       st->pd_gpio_mode != ADAQ8092_PD1_ON_PD2_ON;
+}
+
+static void adaq8092_reconfig_begin(struct iio_dev *indio_dev,
+				    enum adaq8092_reconfig_class class)
+{
+	struct axiadc_state *axi_adc_st = iio_priv(indio_dev);
+	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
+
+	mutex_lock(&st->lock);
+
+	st->reconfig_quiesced = class == ADAQ8092_QUIESCE &&
+				(iio_buffer_enabled(indio_dev) ||
+				 st->reconfig_held);
+	if (!st->reconfig_quiesced)
+		return;
+
+	st->reconfig_start = ktime_get();
+
+	/* Hold the data path in reset, the interface clock keeps running */
+	st->axi_ops->write(axi_adc_st, ADI_REG_RSTN, ADI_MMCM_RSTN);
+}
+
+static int adaq8092_reconfig_end(struct iio_dev *indio_dev, int ret)
+{
+	struct axiadc_state *axi_adc_st = iio_priv(indio_dev);
+	struct axiadc_converter *conv = iio_device_get_drvdata(indio_dev);
+	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
+	unsigned int status;
+	int i, err;
+
+	/* Nothing to realign to, release the data path once the outputs run */
+	if (st->reconfig_quiesced && adaq8092_dout_stopped(st)) {
+		st->reconfig_held = true;
+		st->reconfig_quiesced = false;
+	}
+
+	if (st->reconfig_quiesced) {
+		st->reconfig_held = false;
+		st->axi_ops->write(axi_adc_st, ADI_REG_RSTN, ADI_MMCM_RSTN | ADI_RSTN);
+
+		err = read_poll_timeout(st->axi_ops->read, status,
+					status & ADI_STATUS, 10,
+					ADAQ8092_REALIGN_TIMEOUT_US, false,
+					axi_adc_st, ADI_REG_STATUS);
+		if (err)
+			dev_err(&st->spi->dev, "data interface did not realign\n");
+
+		/* Drop PN/over-range flags raised while the link was down */
+		for (i = 0; i < conv->chip_info->num_channels; i++)
+			st->axi_ops->write(axi_adc_st, ADI_REG_CHAN_STATUS(i), ~0);
+
+		st->realign_ns = ktime_to_ns(ktime_sub(ktime_get(),
+						       st->reconfig_start));
+		st->realign_count++;
+		st->reconfig_quiesced = false;
+
+		if (!ret)
+			ret = err;
+	}
+
+	if (!ret)
+		st->reconfig_count++;
+
+	mutex_unlock(&st->lock);
+
+	return ret;
+}
+
 static int adaq8092_update_dout_config(struct iio_dev *indio_dev, enum adaq8092_dout_modes mode)
 {
 	struct axiadc_state *axi_adc_st = iio_priv(indio_dev);
 	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
+	enum adaq8092_clk_phase_delay clk_phase_mode;
+	enum adaq8092_clk_dutycycle clk_dc_mode;
+	enum adaq8092_clk_invert clk_pol_mode;
 	unsigned int data, sdr_ddr_n;
 	int ret;
 
 	switch (mode) {
 	case ADAQ8092_FULL_RATE_CMOS:
 		sdr_ddr_n = BIT(16);
-
-		ret = regmap_write(st->regmap, ADAQ8092_REG_TIMING,
-				   FIELD_PREP(ADAQ8092_CLK_INVERT, ADAQ8092_CLK_POL_NORMAL) |
-				   FIELD_PREP(ADAQ8092_CLK_PHASE, ADAQ8092_NO_DELAY) |
-				   FIELD_PREP(ADAQ8092_CLK_DUTYCYCLE, ADAQ8092_CLK_DC_STABILIZER_OFF));
-		if (ret)
-			return ret;
-
-		st->clk_pol_mode = ADAQ8092_CLK_POL_NORMAL;
-		st->clk_phase_mode = ADAQ8092_NO_DELAY;
-		st->clk_dc_mode = ADAQ8092_CLK_DC_STABILIZER_OFF;
-
+		clk_pol_mode = ADAQ8092_CLK_POL_NORMAL;
+		clk_phase_mode = ADAQ8092_NO_DELAY;
+		clk_dc_mode = ADAQ8092_CLK_DC_STABILIZER_OFF;
 		break;
 	case ADAQ8092_DOUBLE_RATE_CMOS:
 		sdr_ddr_n = 0;
-
-		ret = regmap_write(st->regmap, ADAQ8092_REG_TIMING,
-				   FIELD_PREP(ADAQ8092_CLK_INVERT, ADAQ8092_CLK_POL_INVERTED) |
-				   FIELD_PREP(ADAQ8092_CLK_PHASE, ADAQ8092_CLKOUT_DELAY_45DEG) |
-				   FIELD_PREP(ADAQ8092_CLK_DUTYCYCLE, ADAQ8092_CLK_DC_STABILIZER_ON));
-		if (ret)
-			return ret;
-
-		st->clk_pol_mode = ADAQ8092_CLK_POL_INVERTED;
-		st->clk_phase_mode = ADAQ8092_CLKOUT_DELAY_45DEG;
-		st->clk_dc_mode = ADAQ8092_CLK_DC_STABILIZER_ON;
-
+		clk_pol_mode = ADAQ8092_CLK_POL_INVERTED;
+		clk_phase_mode = ADAQ8092_CLKOUT_DELAY_45DEG;
+		clk_dc_mode = ADAQ8092_CLK_DC_STABILIZER_ON;
 		break;
 	case ADAQ8092_DOUBLE_RATE_LVDS:
 		sdr_ddr_n = 0;
+		clk_pol_mode = ADAQ8092_CLK_POL_INVERTED;
+		clk_phase_mode = ADAQ8092_NO_DELAY;
+		clk_dc_mode = ADAQ8092_CLK_DC_STABILIZER_OFF;
+		break;
+	default:
+		return -EINVAL;
+	}
 
+	/* Timing given in the device tree wins over the per mode defaults */
+	if (!st->timing_fixed) {
 		ret = regmap_write(st->regmap, ADAQ8092_REG_TIMING,
-				   FIELD_PREP(ADAQ8092_CLK_INVERT, ADAQ8092_CLK_POL_INVERTED) |
-				   FIELD_PREP(ADAQ8092_CLK_PHASE, ADAQ8092_NO_DELAY) |
-				   FIELD_PREP(ADAQ8092_CLK_DUTYCYCLE, ADAQ8092_CLK_DC_STABILIZER_OFF));
+				   FIELD_PREP(ADAQ8092_CLK_INVERT, clk_pol_mode) |
+				   FIELD_PREP(ADAQ8092_CLK_PHASE, clk_phase_mode) |
+				   FIELD_PREP(ADAQ8092_CLK_DUTYCYCLE, clk_dc_mode));
 		if (ret)
 			return ret;
 
-		st->clk_pol_mode = ADAQ8092_CLK_POL_INVERTED;
-		st->clk_phase_mode = ADAQ8092_NO_DELAY;
-		st->clk_dc_mode = ADAQ8092_CLK_DC_STABILIZER_OFF;
-
-		break;
-	default:
-		return -EINVAL;
+		st->clk_pol_mode = clk_pol_mode;
+		st->clk_phase_mode = clk_phase_mode;
+		st->clk_dc_mode = clk_dc_mode;
 	}
 
-	data = axiadc_read(axi_adc_st, ADI_REG_CNTRL);
+	data = st->axi_ops->read(axi_adc_st, ADI_REG_CNTRL);
 	data &= ~BIT(16);
 	data |= sdr_ddr_n;
-	axiadc_write(axi_adc_st, ADI_REG_CNTRL, data);
+	st->axi_ops->write(axi_adc_st, ADI_REG_CNTRL, data);
+
+	if (st->dout_switchable) {
+		data = st->axi_ops->read(axi_adc_st, ADAQ8092_AXI_REG_CNTRL);
+		data &= ~ADAQ8092_AXI_CMOS_SEL;
+		if (mode != ADAQ8092_DOUBLE_RATE_LVDS)
+			data |= ADAQ8092_AXI_CMOS_SEL;
+		st->axi_ops->write(axi_adc_st, ADAQ8092_AXI_REG_CNTRL, data);
+	}
 
 	ret = regmap_update_bits(st->regmap, ADAQ8092_REG_OUTPUT_MODE,
 				 ADAQ8092_OUTMODE,
@@ -361,15 +605,15 @@ static int adaq8092_set_pd_mode(struct iio_dev *indio_dev,
 	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
 	int ret;
 
+	adaq8092_reconfig_begin(indio_dev, ADAQ8092_QUIESCE);
+
 	ret = regmap_update_bits(st->regmap, ADAQ8092_REG_POWERDOWN,
 				 ADAQ8092_POWERDOWN_MODE,
 				 FIELD_PREP(ADAQ8092_POWERDOWN_MODE, mode));
-	if (ret)
-		return ret;
-
-	st->pd_mode = mode;
+	if (!ret)
+		st->pd_mode = mode;
 
-	return 0;
+	return adaq8092_reconfig_end(indio_dev, ret);
 }
 
 static int adaq8092_get_pd_mode(struct iio_dev *indio_dev,
@@ -387,15 +631,15 @@ static int adaq8092_set_clk_pol_mode(struct iio_dev *indio_dev,
 	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
 	int ret;
 
+	adaq8092_reconfig_begin(indio_dev, ADAQ8092_QUIESCE);
+
 	ret = regmap_update_bits(st->regmap, ADAQ8092_REG_TIMING,
 				 ADAQ8092_CLK_INVERT,
 				 FIELD_PREP(ADAQ8092_CLK_INVERT, mode));
-	if (ret)
-		return ret;
+	if (!ret)
+		st->clk_pol_mode = mode;
 
-	st->clk_pol_mode = mode;
-
-	return 0;
+	return adaq8092_reconfig_end(indio_dev, ret);
 }
 
 static int adaq8092_get_clk_pol_mode(struct iio_dev *indio_dev,
@@ -413,15 +657,15 @@ static int adaq8092_set_clk_phase_mode(struct iio_dev *indio_dev,
 	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
 	int ret;
 
+	adaq8092_reconfig_begin(indio_dev, ADAQ8092_QUIESCE);
+
 	ret = regmap_update_bits(st->regmap, ADAQ8092_REG_TIMING,
 				 ADAQ8092_CLK_PHASE,
 				 FIELD_PREP(ADAQ8092_CLK_PHASE, mode));
-	if (ret)
-		return ret;
-
-	st->clk_phase_mode = mode;
+	if (!ret)
+		st->clk_phase_mode = mode;
 
-	return 0;
+	return adaq8092_reconfig_end(indio_dev, ret);
 }
 
 static int adaq8092_get_clk_phase_mode(struct iio_dev *indio_dev,
@@ -439,15 +683,15 @@ static int adaq8092_set_clk_dc_mode(struct iio_dev *indio_dev,
 	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
 	int ret;
 
+	adaq8092_reconfig_begin(indio_dev, ADAQ8092_QUIESCE);
+
 	ret = regmap_update_bits(st->regmap, ADAQ8092_REG_TIMING,
 				 ADAQ8092_CLK_DUTYCYCLE,
 				 FIELD_PREP(ADAQ8092_CLK_DUTYCYCLE, mode));
-	if (ret)
-		return ret;
-
-	st->clk_dc_mode = mode;
+	if (!ret)
+		st->clk_dc_mode = mode;
 
-	return 0;
+	return adaq8092_reconfig_end(indio_dev, ret);
 }
 
 static int adaq8092_get_clk_dc_mode(struct iio_dev *indio_dev,
@@ -465,15 +709,15 @@ static int adaq8092_set_lvds_cur_mode(struct iio_dev *indio_dev,
 	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
 	int ret;
 
+	adaq8092_reconfig_begin(indio_dev, ADAQ8092_HOT_SWAP);
+
 	ret = regmap_update_bits(st->regmap, ADAQ8092_REG_OUTPUT_MODE,
 				 ADAQ8092_ILVDS,
 				 FIELD_PREP(ADAQ8092_ILVDS, mode));
-	if (ret)
-		return ret;
-
-	st->lvds_cur_mode = mode;
+	if (!ret)
+		st->lvds_cur_mode = mode;
 
-	return 0;
+	return adaq8092_reconfig_end(indio_dev, ret);
 }
 
 static int adaq8092_get_lvds_cur_mode(struct iio_dev *indio_dev,
@@ -491,15 +735,15 @@ static int adaq8092_set_lvds_term_mode(struct iio_dev *indio_dev,
 	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
 	int ret;
 
+	adaq8092_reconfig_begin(indio_dev, ADAQ8092_HOT_SWAP);
+
 	ret = regmap_update_bits(st->regmap, ADAQ8092_REG_OUTPUT_MODE,
 				 ADAQ8092_TERMON,
 				 FIELD_PREP(ADAQ8092_TERMON, mode));
-	if (ret)
-		return ret;
-
-	st->lvds_term_mode = mode;
+	if (!ret)
+		st->lvds_term_mode = mode;
 
-	return 0;
+	return adaq8092_reconfig_end(indio_dev, ret);
 }
 
 static int adaq8092_get_lvds_term_mode(struct iio_dev *indio_dev,
@@ -517,15 +761,15 @@ static int adaq8092_set_dout_en(struct iio_dev *indio_dev,
 	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
 	int ret;
 
+	adaq8092_reconfig_begin(indio_dev, ADAQ8092_QUIESCE);
+
 	ret = regmap_update_bits(st->regmap, ADAQ8092_REG_OUTPUT_MODE,
 				 ADAQ8092_OUTOFF,
 				 FIELD_PREP(ADAQ8092_OUTOFF, mode));
-	if (ret)
-		return ret;
-
-	st->dout_en = mode;
+	if (!ret)
+		st->dout_en = mode;
 
-	return 0;
+	return adaq8092_reconfig_end(indio_dev, ret);
 }
 
 static int adaq8092_get_dout_en(struct iio_dev *indio_dev,
@@ -541,14 +785,38 @@ static int adaq8092_set_dout_mode(struct iio_dev *indio_dev,
 				  unsigned int mode)
 {
 	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
+	unsigned int data;
+	ktime_t start, end;
+	int ret;
 
-	if (st->dout_mode != ADAQ8092_DOUBLE_RATE_LVDS && mode == ADAQ8092_DOUBLE_RATE_LVDS)
-		return -EINVAL;
+	adaq8092_reconfig_begin(indio_dev, ADAQ8092_QUIESCE);
 
-	if (st->dout_mode == ADAQ8092_DOUBLE_RATE_LVDS && mode != ADAQ8092_DOUBLE_RATE_LVDS)
-		return -EINVAL;
+	/* Timed under the lock, contention is not part of the switch */
+	start = ktime_get();
+
+	/* Crossing LVDS <-> CMOS needs an HDL build with both interfaces */
+	if (!st->dout_switchable &&
+	    (st->dout_mode == ADAQ8092_DOUBLE_RATE_LVDS) !=
+	    (mode == ADAQ8092_DOUBLE_RATE_LVDS))
+		return adaq8092_reconfig_end(indio_dev, -EINVAL);
+
+	ret = adaq8092_update_dout_config(indio_dev, mode);
+	if (!ret)
+		ret = regmap_read(st->regmap, ADAQ8092_REG_OUTPUT_MODE, &data);
+	if (!ret && FIELD_GET(ADAQ8092_OUTMODE, data) != mode)
+		ret = -EIO;
 
-	return adaq8092_update_dout_config(indio_dev, mode);
+	ret = adaq8092_reconfig_end(indio_dev, ret);
+	if (ret)
+		return ret;
+
+	end = ktime_get();
+
+	mutex_lock(&st->lock);
+	st->dout_switch_ns = ktime_to_ns(ktime_sub(end, start));
+	mutex_unlock(&st->lock);
+
+	return 0;
 }
 
 static int adaq8092_get_dout_mode(struct iio_dev *indio_dev,
@@ -566,15 +834,15 @@ static int adaq8092_set_test_mode(struct iio_dev *indio_dev,
 	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
 	int ret;
 
+	adaq8092_reconfig_begin(indio_dev, ADAQ8092_HOT_SWAP);
+
 	ret = regmap_update_bits(st->regmap, ADAQ8092_REG_DATA_FORMAT,
 				 ADAQ8092_OUTTEST,
 				 FIELD_PREP(ADAQ8092_OUTTEST, mode));
-	if (ret)
-		return ret;
-
-	st->test_mode = mode;
+	if (!ret)
+		st->test_mode = mode;
 
-	return 0;
+	return adaq8092_reconfig_end(indio_dev, ret);
 }
 
 static int adaq8092_get_test_mode(struct iio_dev *indio_dev,
@@ -585,45 +853,70 @@ static int adaq8092_get_test_mode(struct iio_dev *indio_dev,
 	return st->test_mode;
 }
 
+/*
+ * Offset binary and the alternate bit polarity both invert the MSB. The AXI
+ * core inverts it back, so samples always reach the buffer as sign extended
+ * two's complement.
+ */
+static unsigned int adaq8092_axi_format(enum adaq8092_twoscomp twos_comp,
+					enum adaq8092_alt_bit_pol alt_bit_pol)
+{
+	if ((twos_comp == ADAQ8092_OFFSET_BINARY) !=
+	    (alt_bit_pol == ADAQ8092_ALT_BIT_POL_ON))
+		return ADI_FORMAT_TYPE;
+
+	return 0;
+}
+
+static void adaq8092_axi_format_write(struct iio_dev *indio_dev,
+				      unsigned int format)
+{
+	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
+	struct axiadc_state *axi_adc_st = iio_priv(indio_dev);
+	struct axiadc_converter *conv = iio_device_get_drvdata(indio_dev);
+	unsigned int data;
+	int i;
+
+	for (i = 0; i < conv->chip_info->num_channels; i++) {
+		data = st->axi_ops->read(axi_adc_st, ADI_REG_CHAN_CNTRL(i));
+		data &= ~ADI_FORMAT_TYPE;
+		data |= format;
+		st->axi_ops->write(axi_adc_st, ADI_REG_CHAN_CNTRL(i), data);
+	}
+}
+
 static int adaq8092_set_alt_pol_en(struct iio_dev *indio_dev,
 				   const struct iio_chan_spec *chan,
 				   unsigned int mode)
 {
 	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
 	struct axiadc_state *axi_adc_st = iio_priv(indio_dev);
-	struct axiadc_converter *conv = iio_device_get_drvdata(indio_dev);
-	unsigned int data, axi_pol_en, axi_pol_en_ch;
-	int ret, i;
+	unsigned int data, axi_pol_en;
+	int ret;
 
-	if (mode == ADAQ8092_ALT_BIT_POL_ON) {
-		axi_pol_en_ch = ADI_FORMAT_TYPE;
-		axi_pol_en = BIT(1);
-	} else {
-		axi_pol_en_ch = 0;
+	if (mode == ADAQ8092_ALT_BIT_POL_ON)
+		axi_pol_en = ADAQ8092_AXI_ABP;
+	else
 		axi_pol_en = 0;
-	}
 
-	for (i = 0; i < conv->chip_info->num_channels; i++) {
-		data = axiadc_read(axi_adc_st, ADI_REG_CHAN_CNTRL(i));
-		data &= ~ADI_FORMAT_TYPE;
-		data |= axi_pol_en_ch;
-		axiadc_write(axi_adc_st, ADI_REG_CHAN_CNTRL(i), data);
-	}
+	/* The AXI core and the device must switch encoding together */
+	adaq8092_reconfig_begin(indio_dev, ADAQ8092_QUIESCE);
+
+	adaq8092_axi_format_write(indio_dev,
+				  adaq8092_axi_format(st->twos_comp, mode));
 
-	data = axiadc_read(axi_adc_st, 0x4c);
-	data &= ~BIT(1);
+	data = st->axi_ops->read(axi_adc_st, ADAQ8092_AXI_REG_CNTRL);
+	data &= ~ADAQ8092_AXI_ABP;
 	data |= axi_pol_en;
-	axiadc_write(axi_adc_st, 0x4c, data);
+	st->axi_ops->write(axi_adc_st, ADAQ8092_AXI_REG_CNTRL, data);
 
 	ret = regmap_update_bits(st->regmap, ADAQ8092_REG_DATA_FORMAT,
 				 ADAQ8092_ABP,
 				 FIELD_PREP(ADAQ8092_ABP, mode));
-	if (ret)
-		return ret;
-
-	st->alt_bit_pol_en = mode;
+	if (!ret)
+		st->alt_bit_pol_en = mode;
 
-	return 0;
+	return adaq8092_reconfig_end(indio_dev, ret);
 }
 
 static int adaq8092_get_alt_pol_en(struct iio_dev *indio_dev,
@@ -644,24 +937,24 @@ static int adaq8092_set_data_rand_en(struct iio_dev *indio_dev,
 	int ret;
 
 	if (mode == ADAQ8092_DATA_RAND_ON)
-		axi_data_rand_en = BIT(0);
+		axi_data_rand_en = ADAQ8092_AXI_RAND;
 	else
 		axi_data_rand_en = 0;
 
-	data = axiadc_read(axi_adc_st, 0x4c);
-	data &= ~BIT(0);
+	adaq8092_reconfig_begin(indio_dev, ADAQ8092_QUIESCE);
+
+	data = st->axi_ops->read(axi_adc_st, ADAQ8092_AXI_REG_CNTRL);
+	data &= ~ADAQ8092_AXI_RAND;
 	data |= axi_data_rand_en;
-	axiadc_write(axi_adc_st, 0x4c, data);
+	st->axi_ops->write(axi_adc_st, ADAQ8092_AXI_REG_CNTRL, data);
 
 	ret = regmap_update_bits(st->regmap, ADAQ8092_REG_DATA_FORMAT,
 				 ADAQ8092_RAND,
 				 FIELD_PREP(ADAQ8092_RAND, mode));
-	if (ret)
-		return ret;
+	if (!ret)
+		st->data_rand_en = mode;
 
-	st->data_rand_en = mode;
-
-	return 0;
+	return adaq8092_reconfig_end(indio_dev, ret);
 }
 
 static int adaq8092_get_data_rand_en(struct iio_dev *indio_dev,
@@ -679,15 +972,19 @@ static int adaq8092_set_twos_comp(struct iio_dev *indio_dev,
 	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
 	int ret;
 
+	/* The AXI core and the device must switch encoding together */
+	adaq8092_reconfig_begin(indio_dev, ADAQ8092_QUIESCE);
+
+	adaq8092_axi_format_write(indio_dev,
+				  adaq8092_axi_format(mode, st->alt_bit_pol_en));
+
 	ret = regmap_update_bits(st->regmap, ADAQ8092_REG_DATA_FORMAT,
 				 ADAQ8092_TWOSCOMP,
 				 FIELD_PREP(ADAQ8092_TWOSCOMP, mode));
-	if (ret)
-		return ret;
-
-	st->twos_comp = mode;
+	if (!ret)
+		st->twos_comp = mode;
 
-	return 0;
+	return adaq8092_reconfig_end(indio_dev, ret);
 }
 
 static int adaq8092_get_twos_comp(struct iio_dev *indio_dev,
@@ -713,6 +1010,9 @@ static int adaq8092_set_pd_gpio_mode(struct iio_dev *indio_dev,
 				     unsigned int mode)
 {
 	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
+	int ret = 0;
+
+	adaq8092_reconfig_begin(indio_dev, ADAQ8092_QUIESCE);
 
 	switch (mode) {
 	case ADAQ8092_PD1_ON_PD2_ON:
@@ -732,12 +1032,14 @@ static int adaq8092_set_pd_gpio_mode(struct iio_dev *indio_dev,
 		gpiod_set_value(st->gpio_adc_pd2, 0);
 		break;
 	default:
-		return -EINVAL;
+		ret = -EINVAL;
+		break;
 	}
 
-	st->pd_gpio_mode = mode;
+	if (!ret)
+		st->pd_gpio_mode = mode;
 
-	return 0;
+	return adaq8092_reconfig_end(indio_dev, ret);
 }
 
 static int adaq8092_get_pd_gpio_mode(struct iio_dev *indio_dev,
@@ -858,6 +1160,77 @@ static const struct iio_enum adaq8092_pd_gpio_enum = {
 	.set = adaq8092_set_pd_gpio_mode
 };
 
+static ssize_t adaq8092_spi_freq_read(struct iio_dev *indio_dev,
+				      uintptr_t private,
+				      const struct iio_chan_spec *chan,
+				      char *buf)
+{
+	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
+
+	return sysfs_emit(buf, "%u\n", st->spi->max_speed_hz);
+}
+
+static ssize_t adaq8092_status_count_read(struct iio_dev *indio_dev,
+					  uintptr_t private,
+					  const struct iio_chan_spec *chan,
+					  char *buf)
+{
+	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
+	unsigned int count;
+
+	mutex_lock(&st->lock);
+	if (private == ADAQ8092_OVER_RANGE)
+		count = st->over_range[chan->channel];
+	else
+		count = st->link_errors[chan->channel];
+	mutex_unlock(&st->lock);
+
+	return sysfs_emit(buf, "%u\n", count);
+}
+
+static ssize_t adaq8092_reconfig_read(struct iio_dev *indio_dev,
+				      uintptr_t private,
+				      const struct iio_chan_spec *chan,
+				      char *buf)
+{
+	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
+	ssize_t ret;
+
+	mutex_lock(&st->lock);
+
+	switch (private) {
+	case ADAQ8092_RECONFIG_COUNT:
+		ret = sysfs_emit(buf, "%u\n", st->reconfig_count);
+		break;
+	case ADAQ8092_REALIGN_COUNT:
+		ret = sysfs_emit(buf, "%u\n", st->realign_count);
+		break;
+	case ADAQ8092_REALIGN_TIME:
+		ret = sysfs_emit(buf, "%llu\n", st->realign_ns);
+		break;
+	case ADAQ8092_DOUT_SWITCH_TIME:
+		ret = sysfs_emit(buf, "%llu\n", st->dout_switch_ns);
+		break;
+	case ADAQ8092_RESET_TIME:
+		ret = sysfs_emit(buf, "%llu\n", st->reset_ns);
+		break;
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	mutex_unlock(&st->lock);
+
+	return ret;
+}
+
+#define ADAQ8092_RECONFIG_ATTR(_name, _what) {				\
+	.name = _name,							\
+	.shared = IIO_SHARED_BY_ALL,					\
+	.read = adaq8092_reconfig_read,					\
+	.private = _what,						\
+}
+
 static const struct iio_chan_spec_ext_info adaq8092_ext_info[] = {
 	IIO_ENUM("pd_mode", IIO_SHARED_BY_ALL, &adaq8092_pd_mode_enum),
 	IIO_ENUM_AVAILABLE_SHARED("pd_mode", IIO_SHARED_BY_ALL, &adaq8092_pd_mode_enum),
@@ -886,12 +1259,50 @@ static const struct iio_chan_spec_ext_info adaq8092_ext_info[] = {
 	IIO_ENUM("pd_gpio", IIO_SHARED_BY_ALL, &adaq8092_pd_gpio_enum),
 	IIO_ENUM_AVAILABLE_SHARED("pd_gpio", IIO_SHARED_BY_ALL, &adaq8092_pd_gpio_enum),
 	IIO_ENUM("par_ser_gpio", IIO_SHARED_BY_ALL, &adaq8092_par_ser_gpio_enum),
+	{
+		.name = "spi_clk_freq",
+		.shared = IIO_SHARED_BY_ALL,
+		.read = adaq8092_spi_freq_read,
+	},
+	ADAQ8092_RECONFIG_ATTR("reconfig_count", ADAQ8092_RECONFIG_COUNT),
+	ADAQ8092_RECONFIG_ATTR("realign_count", ADAQ8092_REALIGN_COUNT),
+	ADAQ8092_RECONFIG_ATTR("realign_time_ns", ADAQ8092_REALIGN_TIME),
+	ADAQ8092_RECONFIG_ATTR("dout_switch_time_ns", ADAQ8092_DOUT_SWITCH_TIME),
+	ADAQ8092_RECONFIG_ATTR("reset_time_ns", ADAQ8092_RESET_TIME),
+	{
+		.name = "link_errors",
+		.shared = IIO_SEPARATE,
+		.read = adaq8092_status_count_read,
+		.private = ADAQ8092_LINK_ERRORS,
+	},
+	{
+		.name = "over_range_count",
+		.shared = IIO_SEPARATE,
+		.read = adaq8092_status_count_read,
+		.private = ADAQ8092_OVER_RANGE,
+	},
 	{ },
 };
 
+/* Link errors and input over-range seen by the background monitor */
+static const struct iio_event_spec adaq8092_events[] = {
+	{
+		.type = IIO_EV_TYPE_CHANGE,
+		.dir = IIO_EV_DIR_NONE,
+	},
+	{
+		.type = IIO_EV_TYPE_THRESH,
+		.dir = IIO_EV_DIR_EITHER,
+	},
+};
+
 #define ADAQ8092_CHAN(_channel, _name)						\
 	{								\
 		.type = IIO_VOLTAGE,					\
+		.info_mask_separate = BIT(IIO_CHAN_INFO_SCALE) |	\
+			BIT(IIO_CHAN_INFO_OFFSET) |				\
+			BIT(IIO_CHAN_INFO_CALIBBIAS) |				\
+			BIT(IIO_CHAN_INFO_CALIBSCALE),				\
 		.info_mask_shared_by_all = BIT(IIO_CHAN_INFO_SAMP_FREQ),\
 		.address = _channel,					\
 		.indexed = 1,						\
@@ -899,6 +1310,8 @@ static const struct iio_chan_spec_ext_info adaq8092_ext_info[] = {
 		.scan_index = _channel,					\
 		.extend_name = _name#_channel,					\
 		.ext_info = adaq8092_ext_info,				\
+		.event_spec = adaq8092_events,				\
+		.num_event_specs = ARRAY_SIZE(adaq8092_events),		\
 		.scan_type = {						\
 			.sign = 's',					\
 			.realbits = 14,					\
@@ -914,6 +1327,35 @@ static const struct axiadc_chip_info conv_chip_info = {
 	.channel[1] = ADAQ8092_CHAN(1, "channel"),
 };
 
+/*
+ * Program the offset and gain correction of one channel into the AXI core:
+ * the DC filter adds calibbias, the IQ correction multiplies by calibscale
+ * with the cross-channel coefficient zeroed. Both stay bypassed at their
+ * neutral values.
+ */
+static void adaq8092_calib_write(struct iio_dev *indio_dev, unsigned int ch)
+{
+	struct axiadc_state *axi_adc_st = iio_priv(indio_dev);
+	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
+	unsigned int data, coeff;
+
+	coeff = DIV_ROUND_CLOSEST_ULL((u64)st->calibscale[ch] <<
+				      ADAQ8092_CALIBSCALE_FRAC_BITS, MICRO);
+
+	st->axi_ops->write(axi_adc_st, ADI_REG_CHAN_CNTRL_1(ch),
+			   ADI_DCFILT_OFFSET(st->calibbias[ch]));
+	st->axi_ops->write(axi_adc_st, ADI_REG_CHAN_CNTRL_2(ch),
+			   ADI_IQCOR_COEFF_1(coeff) | ADI_IQCOR_COEFF_2(0));
+
+	data = st->axi_ops->read(axi_adc_st, ADI_REG_CHAN_CNTRL(ch));
+	data &= ~(ADI_DCFILT_ENB | ADI_IQCOR_ENB);
+	if (st->calibbias[ch])
+		data |= ADI_DCFILT_ENB;
+	if (st->calibscale[ch] != MICRO)
+		data |= ADI_IQCOR_ENB;
+	st->axi_ops->write(axi_adc_st, ADI_REG_CHAN_CNTRL(ch), data);
+}
+
 static int adaq8092_read_raw(struct iio_dev *indio_dev,
 			     const struct iio_chan_spec *chan,
 			     int *val, int *val2, long info)
@@ -924,6 +1366,22 @@ static int adaq8092_read_raw(struct iio_dev *indio_dev,
 	case IIO_CHAN_INFO_SAMP_FREQ:
 		*val = st->sampling_freq;
 		return IIO_VAL_INT;
+	case IIO_CHAN_INFO_SCALE:
+		/* mV per code: full-scale span over 2^14 codes */
+		*val = st->input_range_uv;
+		*val2 = 1000 << chan->scan_type.realbits;
+		return IIO_VAL_FRACTIONAL;
+	case IIO_CHAN_INFO_OFFSET:
+		/* The AXI core hands out two's complement in either format */
+		*val = 0;
+		return IIO_VAL_INT;
+	case IIO_CHAN_INFO_CALIBBIAS:
+		*val = st->calibbias[chan->channel];
+		return IIO_VAL_INT;
+	case IIO_CHAN_INFO_CALIBSCALE:
+		*val = st->calibscale[chan->channel] / MICRO;
+		*val2 = st->calibscale[chan->channel] % MICRO;
+		return IIO_VAL_INT_PLUS_MICRO;
 	default:
 		return -EINVAL;
 	}
@@ -939,29 +1397,114 @@ static int adaq8092_write_raw(struct iio_dev *indio_dev,
 	case IIO_CHAN_INFO_SAMP_FREQ:
 		st->sampling_freq = val;
 		return 0;
+	case IIO_CHAN_INFO_CALIBBIAS:
+		if (abs(val) > ADAQ8092_CALIBBIAS_MAX)
+			return -EINVAL;
+
+		adaq8092_reconfig_begin(indio_dev, ADAQ8092_HOT_SWAP);
+		st->calibbias[chan->channel] = val;
+		adaq8092_calib_write(indio_dev, chan->channel);
+		return adaq8092_reconfig_end(indio_dev, 0);
+	case IIO_CHAN_INFO_CALIBSCALE:
+		if (val < 0 || val > 1 || val2 < 0 ||
+		    val * MICRO + val2 > ADAQ8092_CALIBSCALE_MAX_MICRO)
+			return -EINVAL;
+
+		adaq8092_reconfig_begin(indio_dev, ADAQ8092_HOT_SWAP);
+		st->calibscale[chan->channel] = val * MICRO + val2;
+		adaq8092_calib_write(indio_dev, chan->channel);
+		return adaq8092_reconfig_end(indio_dev, 0);
 	default:
 		return -EINVAL;
 	}
 }
 
+static int adaq8092_parse_mode(struct adaq8092_state *st, const char *prop,
+			       const char * const *items, unsigned int num_items,
+			       const u32 *values, int def)
+{
+	struct device *dev = &st->spi->dev;
+	unsigned int i;
+	u32 val;
+
+	if (device_property_read_u32(dev, prop, &val))
+		return def;
+
+	for (i = 0; i < num_items; i++) {
+		if (items[i] && (values ? values[i] : i) == val)
+			return i;
+	}
+
+	return dev_err_probe(dev, -EINVAL, "invalid %s: %u\n", prop, val);
+}
+
+static int adaq8092_modes_parse(struct adaq8092_state *st)
+{
+	struct device *dev = &st->spi->dev;
+	int ret;
+
+	ret = adaq8092_parse_mode(st, "adi,power-down-mode", adaq8092_pd_modes,
+				  ARRAY_SIZE(adaq8092_pd_modes), NULL,
+				  ADAQ8092_NORMAL_OP);
+	if (ret < 0)
+		return ret;
+	st->pd_mode = ret;
+
+	ret = adaq8092_parse_mode(st, "adi,clock-phase-delay-degrees",
+				  adaq8092_clk_phase_modes,
+				  ARRAY_SIZE(adaq8092_clk_phase_modes),
+				  adaq8092_clk_phase_deg, ADAQ8092_NO_DELAY);
+	if (ret < 0)
+		return ret;
+	st->clk_phase_mode = ret;
+
+	ret = adaq8092_parse_mode(st, "adi,lvds-current-microamp",
+				  adaq8092_lvds_cur_modes,
+				  ARRAY_SIZE(adaq8092_lvds_cur_modes),
+				  adaq8092_lvds_cur_ua, ADAQ8092_3M5A);
+	if (ret < 0)
+		return ret;
+	st->lvds_cur_mode = ret;
+
+	ret = adaq8092_parse_mode(st, "adi,test-pattern", adaq8092_test_modes,
+				  ARRAY_SIZE(adaq8092_test_modes), NULL,
+				  ADAQ8092_TEST_OFF);
+	if (ret < 0)
+		return ret;
+	st->test_mode = ret;
+
+	st->clk_pol_mode = ADAQ8092_CLK_POL_INVERTED;
+	st->clk_dc_mode = device_property_read_bool(dev, "adi,clock-duty-cycle-stabilizer");
+	st->lvds_term_mode = device_property_read_bool(dev, "adi,lvds-internal-termination");
+	st->alt_bit_pol_en = device_property_read_bool(dev, "adi,alternate-bit-polarity");
+	st->data_rand_en = device_property_read_bool(dev, "adi,data-randomizer");
+	st->dout_en = ADAQ8092_DOUT_ON;
+	st->twos_comp = ADAQ8092_TWOS_COMPLEMENT;
+
+	st->timing_fixed = device_property_present(dev, "adi,clock-phase-delay-degrees") ||
+			   device_property_present(dev, "adi,clock-duty-cycle-stabilizer");
+
+	return 0;
+}
+
 static int adaq8092_properties_parse(struct adaq8092_state *st)
 {
 	struct spi_device *spi = st->spi;
 
 	st->gpio_adc_pd1 = devm_gpiod_get(&st->spi->dev, "adc-pd1",
-					  GPIOD_OUT_HIGH);
+					  GPIOD_ASIS);
 	if (IS_ERR(st->gpio_adc_pd1))
 		return dev_err_probe(&spi->dev, PTR_ERR(st->gpio_adc_pd1),
 				     "failed to get the PD1 GPIO\n");
 
 	st->gpio_adc_pd2 = devm_gpiod_get(&st->spi->dev, "adc-pd2",
-					  GPIOD_OUT_HIGH);
+					  GPIOD_ASIS);
 	if (IS_ERR(st->gpio_adc_pd2))
 		return dev_err_probe(&spi->dev, PTR_ERR(st->gpio_adc_pd2),
 				     "failed to get the PD2 GPIO\n");
 
 	st->gpio_en_1p8 = devm_gpiod_get(&st->spi->dev, "en-1p8",
-					 GPIOD_OUT_HIGH);
+					 GPIOD_ASIS);
 	if (IS_ERR(st->gpio_en_1p8))
 		return dev_err_probe(&spi->dev, PTR_ERR(st->gpio_en_1p8),
 				     "failed to get the 1p8 GPIO\n");
@@ -977,14 +1520,30 @@ static int adaq8092_properties_parse(struct adaq8092_state *st)
 		return dev_err_probe(&spi->dev, PTR_ERR(st->clkin),
 				     "failed to get the input clock\n");
 
-	return 0;
+	st->spi_autotune = device_property_read_bool(&spi->dev,
+						     "adi,spi-autotune");
+
+	st->dout_switchable = device_property_read_bool(&spi->dev,
+							"adi,output-mode-switchable");
+
+	st->input_range_uv = ADAQ8092_INPUT_RANGE_UV;
+	device_property_read_u32(&spi->dev, "adi,input-range-microvolt",
+				 &st->input_range_uv);
+
+	st->link_monitor_ms = ADAQ8092_LINK_MONITOR_MS;
+	device_property_read_u32(&spi->dev, "adi,link-monitor-interval-ms",
+				 &st->link_monitor_ms);
+
+	st->pn_monitor = device_property_read_bool(&spi->dev, "adi,pn-monitor");
+
+	return adaq8092_modes_parse(st);
 }
 
 static void adaq8092_powerup(struct adaq8092_state *st)
 {
-	gpiod_set_value(st->gpio_adc_pd1, 0);
-	gpiod_set_value(st->gpio_adc_pd2, 0);
-	gpiod_set_value(st->gpio_en_1p8, 0);
+	gpiod_direction_output(st->gpio_adc_pd1, 0);
+	gpiod_direction_output(st->gpio_adc_pd2, 0);
+	gpiod_direction_output(st->gpio_en_1p8, 0);
 
 	msleep(1000);
 
@@ -1004,15 +1563,96 @@ static void adaq8092_clk_disable(void *data)
 	clk_disable_unprepare(data);
 }
 
+/*
+ * Poll the AXI core status: the interface lock, the per channel over-range
+ * flag and, with adi,pn-monitor, the per channel PN checker flags. The channel
+ * flags are sticky, so an excursion between two polls is never lost. Every
+ * channel that saw an error or an over-range gets its counter bumped and an
+ * event, without touching the sample stream.
+ */
+static void adaq8092_link_check(struct adaq8092_state *st)
+{
+	struct iio_dev *indio_dev = st->indio_dev;
+	struct axiadc_state *axi_adc_st = iio_priv(indio_dev);
+	struct axiadc_converter *conv = iio_device_get_drvdata(indio_dev);
+	s64 timestamp = iio_get_time_ns(indio_dev);
+	unsigned int status, mask, over;
+	bool locked;
+	int i;
+
+	mask = st->pn_monitor ? ADI_PN_ERR | ADI_PN_OOS : 0;
+
+	mutex_lock(&st->lock);
+
+	/* The link is down on purpose while the outputs are stopped */
+	if (adaq8092_dout_stopped(st)) {
+		mutex_unlock(&st->lock);
+		return;
+	}
+
+	locked = st->axi_ops->read(axi_adc_st, ADI_REG_STATUS) & ADI_STATUS;
+
+	for (i = 0; i < conv->chip_info->num_channels; i++) {
+		status = st->axi_ops->read(axi_adc_st,
+					   ADI_REG_CHAN_STATUS(i));
+		status &= mask | ADI_OVER_RANGE;
+		if (status)
+			st->axi_ops->write(axi_adc_st, ADI_REG_CHAN_STATUS(i), status);
+
+		over = status & ADI_OVER_RANGE;
+		status &= mask;
+		if (over) {
+			st->over_range[i]++;
+			iio_push_event(indio_dev,
+				       IIO_UNMOD_EVENT_CODE(IIO_VOLTAGE, i,
+							    IIO_EV_TYPE_THRESH,
+							    IIO_EV_DIR_EITHER),
+				       timestamp);
+		}
+
+		if (locked && !status)
+			continue;
+
+		st->link_errors[i]++;
+		iio_push_event(indio_dev,
+			       IIO_UNMOD_EVENT_CODE(IIO_VOLTAGE, i,
+						    IIO_EV_TYPE_CHANGE,
+						    IIO_EV_DIR_NONE),
+			       timestamp);
+	}
+
+	mutex_unlock(&st->lock);
+}
+
+static void adaq8092_link_monitor(struct work_struct *work)
+{
+	struct adaq8092_state *st = container_of(to_delayed_work(work),
+						 struct adaq8092_state,
+						 link_work);
+
+	adaq8092_link_check(st);
+
+	schedule_delayed_work(&st->link_work,
+			      msecs_to_jiffies(st->link_monitor_ms));
+}
+
+static void adaq8092_link_monitor_stop(void *data)
+{
+	struct adaq8092_state *st = data;
+
+	cancel_delayed_work_sync(&st->link_work);
+}
+
 static int adaq8092_post_setup(struct iio_dev *indio_dev)
 {
 	struct axiadc_state *axi_adc_st = iio_priv(indio_dev);
 	struct axiadc_converter *conv = iio_device_get_drvdata(indio_dev);
+	struct adaq8092_state *st = adaq8092_get_data(indio_dev);
 	enum adaq8092_dout_modes mode;
-	unsigned int data;
+	unsigned int data, format;
 	int i, ret;
 
-	data = axiadc_read(axi_adc_st, ADI_REG_CONFIG);
+	data = st->axi_ops->read(axi_adc_st, ADI_REG_CONFIG);
 	data &= ADI_CMOS_OR_LVDS_N;
 
 	if (data)
@@ -1024,13 +1664,291 @@ static int adaq8092_post_setup(struct iio_dev *indio_dev)
 	if (ret)
 		return ret;
 
-	for (i = 0; i < conv->chip_info->num_channels; i++)
-		axiadc_write(axi_adc_st, ADI_REG_CHAN_CNTRL(i), ADI_ENABLE | ADI_FORMAT_ENABLE
-			     | ADI_FORMAT_SIGNEXT);
+	/* Match the AXI decoder to the encoding applied at probe */
+	data = st->axi_ops->read(axi_adc_st, ADAQ8092_AXI_REG_CNTRL);
+	data &= ~(ADAQ8092_AXI_RAND | ADAQ8092_AXI_ABP);
+	if (st->data_rand_en)
+		data |= ADAQ8092_AXI_RAND;
+	if (st->alt_bit_pol_en)
+		data |= ADAQ8092_AXI_ABP;
+	st->axi_ops->write(axi_adc_st, ADAQ8092_AXI_REG_CNTRL, data);
+
+	format = adaq8092_axi_format(st->twos_comp, st->alt_bit_pol_en);
+
+	for (i = 0; i < conv->chip_info->num_channels; i++) {
+		st->axi_ops->write(axi_adc_st, ADI_REG_CHAN_CNTRL(i),
+				   ADI_ENABLE | ADI_FORMAT_ENABLE |
+				   ADI_FORMAT_SIGNEXT | format);
+		adaq8092_calib_write(indio_dev, i);
+	}
+
+	ret = read_poll_timeout(st->axi_ops->read, data, data & ADI_STATUS, 10,
+				ADAQ8092_REALIGN_TIMEOUT_US, false, axi_adc_st,
+				ADI_REG_STATUS);
+	if (ret)
+		dev_warn(&st->spi->dev, "data interface not locked\n");
+
+	/*
+	 * The monitor works on the AXI core, which only exists from here on,
+	 * so it is stopped with the core and not with the SPI device.
+	 */
+	st->indio_dev = indio_dev;
+	INIT_DELAYED_WORK(&st->link_work, adaq8092_link_monitor);
+	ret = devm_add_action_or_reset(indio_dev->dev.parent,
+				       adaq8092_link_monitor_stop, st);
+	if (ret)
+		return ret;
+
+	if (st->link_monitor_ms)
+		mod_delayed_work(system_wq, &st->link_work,
+				 msecs_to_jiffies(st->link_monitor_ms));
+
+	return 0;
+}
+
+static void adaq8092_build_image(struct adaq8092_state *st,
+				 struct reg_sequence *image)
+{
+	const struct reg_sequence seq[ADAQ8092_IMAGE_REGS] = {
+		{ ADAQ8092_REG_POWERDOWN,
+		  FIELD_PREP(ADAQ8092_POWERDOWN_MODE, st->pd_mode) },
+		{ ADAQ8092_REG_TIMING,
+		  FIELD_PREP(ADAQ8092_CLK_INVERT, st->clk_pol_mode) |
+		  FIELD_PREP(ADAQ8092_CLK_PHASE, st->clk_phase_mode) |
+		  FIELD_PREP(ADAQ8092_CLK_DUTYCYCLE, st->clk_dc_mode) },
+		{ ADAQ8092_REG_OUTPUT_MODE,
+		  FIELD_PREP(ADAQ8092_ILVDS, st->lvds_cur_mode) |
+		  FIELD_PREP(ADAQ8092_TERMON, st->lvds_term_mode) |
+		  FIELD_PREP(ADAQ8092_OUTOFF, st->dout_en) |
+		  FIELD_PREP(ADAQ8092_OUTMODE, st->dout_mode) },
+		{ ADAQ8092_REG_DATA_FORMAT,
+		  FIELD_PREP(ADAQ8092_OUTTEST, st->test_mode) |
+		  FIELD_PREP(ADAQ8092_ABP, st->alt_bit_pol_en) |
+		  FIELD_PREP(ADAQ8092_RAND, st->data_rand_en) |
+		  FIELD_PREP(ADAQ8092_TWOSCOMP, st->twos_comp) },
+	};
+
+	memcpy(image, seq, sizeof(seq));
+}
+
+/* Write the whole configuration held in st to the device in one go */
+static int adaq8092_write_image(struct adaq8092_state *st)
+{
+	struct reg_sequence image[ADAQ8092_IMAGE_REGS];
+
+	adaq8092_build_image(st, image);
+
+	return regmap_multi_reg_write(st->regmap, image, ARRAY_SIZE(image));
+}
+
+/* Image bits to compare on a warm restart, post_setup owns the rest */
+static unsigned int adaq8092_image_mask(struct adaq8092_state *st,
+					unsigned int reg)
+{
+	switch (reg) {
+	case ADAQ8092_REG_POWERDOWN:
+		return ADAQ8092_POWERDOWN_MODE;
+	case ADAQ8092_REG_TIMING:
+		return st->timing_fixed ? GENMASK(3, 0) : 0;
+	case ADAQ8092_REG_OUTPUT_MODE:
+		return ADAQ8092_ILVDS | ADAQ8092_TERMON | ADAQ8092_OUTOFF;
+	case ADAQ8092_REG_DATA_FORMAT:
+		return GENMASK(5, 0);
+	default:
+		return 0;
+	}
+}
+
+/*
+ * After a soft reboot or a module reload the part may still be powered, in
+ * serial mode and holding the intended configuration. Detect that so probe
+ * can skip the power cycle and the reset.
+ */
+static bool adaq8092_is_configured(struct adaq8092_state *st)
+{
+	struct reg_sequence image[ADAQ8092_IMAGE_REGS];
+	unsigned int val, mask;
+	int i;
+
+	/* gpiod_get_direction() returns 0 for outputs */
+	if (gpiod_get_direction(st->gpio_en_1p8) ||
+	    gpiod_get_direction(st->gpio_adc_pd1) ||
+	    gpiod_get_direction(st->gpio_adc_pd2))
+		return false;
+
+	if (gpiod_get_value(st->gpio_en_1p8) != 1 ||
+	    gpiod_get_value(st->gpio_adc_pd1) != 1 ||
+	    gpiod_get_value(st->gpio_adc_pd2) != 1 ||
+	    gpiod_get_value(st->gpio_par_ser))
+		return false;
+
+	adaq8092_build_image(st, image);
+
+	for (i = 0; i < ARRAY_SIZE(image); i++) {
+		if (regmap_read(st->regmap, image[i].reg, &val))
+			return false;
+
+		mask = adaq8092_image_mask(st, image[i].reg);
+		if ((val ^ image[i].def) & mask)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * 1 once the configuration registers read back their 0x00 reset defaults.
+ * RESET itself is write-only and reads back undefined data, so it is skipped.
+ */
+static int adaq8092_reset_done(struct adaq8092_state *st)
+{
+	unsigned int reg, val;
+	int ret;
+
+	for (reg = ADAQ8092_REG_POWERDOWN; reg <= ADAQ8092_REG_DATA_FORMAT; reg++) {
+		ret = regmap_read(st->regmap, reg, &val);
+		if (ret)
+			return ret;
+
+		if (val)
+			return 0;
+	}
+
+	return 1;
+}
+
+static int adaq8092_reset(struct adaq8092_state *st)
+{
+	ktime_t start;
+	int ret, done;
+
+	start = ktime_get();
+
+	ret = regmap_write(st->regmap, ADAQ8092_REG_RESET,
+			   FIELD_PREP(ADAQ8092_RESET, 1));
+	if (ret)
+		return ret;
+
+	ret = read_poll_timeout(adaq8092_reset_done, done, done, ADAQ8092_RESET_POLL_US,
+				ADAQ8092_RESET_TIMEOUT_US, false, st);
+	if (ret)
+		return dev_err_probe(&st->spi->dev, ret, "reset did not complete\n");
+	if (done < 0)
+		return done;
+
+	st->reset_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+	dev_dbg(&st->spi->dev, "reset took %llu ns\n", st->reset_ns);
 
 	return 0;
 }
 
+static int adaq8092_spi_verify(struct adaq8092_state *st,
+			       unsigned int data_format)
+{
+	unsigned int timing, format, expected;
+	int i, j, ret;
+
+	for (i = 0; i < ADAQ8092_SPI_AUTOTUNE_PASSES; i++) {
+		for (j = 0; j < ARRAY_SIZE(adaq8092_spi_patterns); j++) {
+			expected = (data_format & ~ADAQ8092_OUTTEST) |
+				   FIELD_PREP(ADAQ8092_OUTTEST,
+					      adaq8092_spi_patterns[j][1]);
+
+			ret = regmap_write(st->regmap, ADAQ8092_REG_TIMING,
+					   adaq8092_spi_patterns[j][0]);
+			if (ret)
+				return ret;
+
+			ret = regmap_write(st->regmap, ADAQ8092_REG_DATA_FORMAT,
+					   expected);
+			if (ret)
+				return ret;
+
+			ret = regmap_read(st->regmap, ADAQ8092_REG_TIMING, &timing);
+			if (ret)
+				return ret;
+
+			ret = regmap_read(st->regmap, ADAQ8092_REG_DATA_FORMAT,
+					  &format);
+			if (ret)
+				return ret;
+
+			if ((timing & GENMASK(3, 0)) != adaq8092_spi_patterns[j][0] ||
+			    (format & GENMASK(5, 0)) != (expected & GENMASK(5, 0)))
+				return -EIO;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Step the SPI clock up to the spi-max-frequency ceiling, stopping at the
+ * first readback failure, and settle one step below the fastest passing rate.
+ * Only writes use the tuned clock, the readback runs at 4 MHz at most.
+ */
+static int adaq8092_spi_autotune(struct adaq8092_state *st)
+{
+	struct spi_device *spi = st->spi;
+	unsigned int timing, data_format;
+	u32 max_hz = spi->max_speed_hz;
+	int i, good = -1, ret;
+
+	ret = regmap_read(st->regmap, ADAQ8092_REG_TIMING, &timing);
+	if (ret)
+		return ret;
+
+	ret = regmap_read(st->regmap, ADAQ8092_REG_DATA_FORMAT, &data_format);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < ARRAY_SIZE(adaq8092_spi_speeds); i++) {
+		if (adaq8092_spi_speeds[i] > max_hz)
+			break;
+
+		spi->max_speed_hz = adaq8092_spi_speeds[i];
+		if (spi_setup(spi) || adaq8092_spi_verify(st, data_format))
+			break;
+
+		good = i;
+	}
+
+	if (good < 0) {
+		spi->max_speed_hz = max_hz;
+		dev_warn(&spi->dev, "SPI autotune failed, keeping %u Hz\n", max_hz);
+	} else {
+		spi->max_speed_hz = adaq8092_spi_speeds[good ? good - 1 : 0];
+		dev_dbg(&spi->dev, "SPI clock set to %u Hz\n", spi->max_speed_hz);
+	}
+
+	ret = spi_setup(spi);
+	if (ret)
+		return ret;
+
+	ret = regmap_write(st->regmap, ADAQ8092_REG_TIMING, timing);
+	if (ret)
+		return ret;
+
+	return regmap_write(st->regmap, ADAQ8092_REG_DATA_FORMAT, data_format);
+}
+
+static unsigned int adaq8092_axi_read(struct axiadc_state *st,
+				      unsigned int reg)
+{
+	return axiadc_read(st, reg);
+}
+
+static void adaq8092_axi_write(struct axiadc_state *st, unsigned int reg,
+			       unsigned int val)
+{
+	axiadc_write(st, reg, val);
+}
+
+static const struct adaq8092_axi_ops adaq8092_axi_ops = {
+	.read = adaq8092_axi_read,
+	.write = adaq8092_axi_write,
+};
+
 static int adaq8092_init(struct adaq8092_state *st)
 {
 	struct spi_device *spi = st->spi;
@@ -1063,11 +1981,23 @@ static int adaq8092_init(struct adaq8092_state *st)
 	conv->post_setup = &adaq8092_post_setup;
 	conv->phy = st;
 
+	st->axi_ops = &adaq8092_axi_ops;
 	st->sampling_freq = 105000000;
+	st->calibscale[0] = MICRO;
+	st->calibscale[1] = MICRO;
 
 	/* Without this, the axi_adc won't find the converter data */
 	spi_set_drvdata(st->spi, conv);
 
+	if (adaq8092_is_configured(st)) {
+		dev_dbg(&spi->dev, "already configured, skipping power cycle\n");
+
+		if (st->spi_autotune)
+			return adaq8092_spi_autotune(st);
+
+		return 0;
+	}
+
 	adaq8092_powerup(st);
 
 	if (gpiod_get_value(st->gpio_par_ser)) {
@@ -1076,22 +2006,17 @@ static int adaq8092_init(struct adaq8092_state *st)
 		return 0;
 	}
 
-	ret = regmap_write(st->regmap, ADAQ8092_REG_RESET,
-			   FIELD_PREP(ADAQ8092_RESET, 1));
-	if (ret)
-		return ret;
-
-	st->clk_pol_mode = ADAQ8092_CLK_POL_INVERTED;
-
-	ret = regmap_update_bits(st->regmap, ADAQ8092_REG_TIMING, ADAQ8092_CLK_INVERT,
-				 FIELD_PREP(ADAQ8092_CLK_INVERT, st->clk_pol_mode));
+	ret = adaq8092_reset(st);
 	if (ret)
 		return ret;
 
-	st->twos_comp = ADAQ8092_TWOS_COMPLEMENT;
+	if (st->spi_autotune) {
+		ret = adaq8092_spi_autotune(st);
+		if (ret)
+			return ret;
+	}
 
-	return regmap_update_bits(st->regmap, ADAQ8092_REG_DATA_FORMAT, ADAQ8092_TWOSCOMP,
-				  FIELD_PREP(ADAQ8092_TWOSCOMP, st->twos_comp));
+	return adaq8092_write_image(st);
 }
 
 static int adaq8092_probe(struct spi_device *spi)
@@ -1104,13 +2029,14 @@ static int adaq8092_probe(struct spi_device *spi)
 	if (!indio_dev)
 		return -ENOMEM;
 
-	regmap = devm_regmap_init_spi(spi, &adaq8092_regmap_config);
+	st = iio_priv(indio_dev);
+	st->spi = spi;
+
+	regmap = devm_regmap_init(&spi->dev, NULL, st, &adaq8092_regmap_config);
 	if (IS_ERR(regmap))
 		return PTR_ERR(regmap);
 
-	st = iio_priv(indio_dev);
 	st->regmap = regmap;
-	st->spi = spi;
 
 	mutex_init(&st->lock);
 
@@ -1142,3 +2068,7 @@ module_spi_driver(adaq8092_driver);
 MODULE_AUTHOR("Antoniu Miclaus <antoniu.miclaus@analog.com");
 MODULE_DESCRIPTION("Analog Devices ADAQ8092");
 MODULE_LICENSE("GPL v2");
+
+#if IS_ENABLED(CONFIG_ADAQ8092_KUNIT_TEST)
+#include "adaq8092_kunit.c"
+#endif
@@ -0,0 +1,599 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * KUnit tests for the ADAQ8092 driver
+ *
+ * Included at the end of adaq8092.c when CONFIG_ADAQ8092_KUNIT_TEST is set,
+ * so the static helpers and ext_info setters are reachable. The SPI side is
+ * a regmap over a RAM register file and the AXI core is a plain array behind
+ * the driver's AXI accessor ops, both counting their accesses so register
+ * traffic per operation can be checked.
+ *
+ * Copyright 2022 Analog Devices Inc.
+ */
+
+#include <kunit/device.h>
+#include <kunit/test.h>
+#include <linux/iio/iio-opaque.h>
+
+/* Register file up to max_register of adaq8092_regmap_config */
+#define ADAQ8092_TEST_SPI_REGS		(0x1A + 1)
+
+/* Covers ADI_REG_CHAN_CNTRL() and ADI_REG_CHAN_STATUS() of both channels */
+#define ADAQ8092_TEST_AXI_REGS		(0x800 / 4)
+
+/* Iterations of the setter benchmark */
+#define ADAQ8092_TEST_BENCH_LOOPS	1000
+
+struct adaq8092_test {
+	struct iio_dev			*indio_dev;
+	struct adaq8092_state		*st;
+	struct axiadc_converter		conv;
+	unsigned int			regs[ADAQ8092_TEST_SPI_REGS];
+	u32				axi[ADAQ8092_TEST_AXI_REGS];
+	unsigned int			spi_reads;
+	unsigned int			spi_writes;
+	unsigned int			axi_reads;
+	unsigned int			axi_writes;
+};
+
+/* The fake core state points at the register array of its test */
+static struct adaq8092_test *adaq8092_test_axi_priv(struct axiadc_state *st)
+{
+	return container_of((u32 __force *)st->regs, struct adaq8092_test,
+			    axi[0]);
+}
+
+static unsigned int adaq8092_test_axi_read(struct axiadc_state *st,
+					   unsigned int reg)
+{
+	struct adaq8092_test *priv = adaq8092_test_axi_priv(st);
+
+	priv->axi_reads++;
+
+	return priv->axi[reg / 4];
+}
+
+static void adaq8092_test_axi_write(struct axiadc_state *st,
+				    unsigned int reg, unsigned int val)
+{
+	struct adaq8092_test *priv = adaq8092_test_axi_priv(st);
+
+	priv->axi_writes++;
+	priv->axi[reg / 4] = val;
+}
+
+static const struct adaq8092_axi_ops adaq8092_test_axi_ops = {
+	.read = adaq8092_test_axi_read,
+	.write = adaq8092_test_axi_write,
+};
+
+static int adaq8092_test_reg_read(void *context, unsigned int reg,
+				  unsigned int *val)
+{
+	struct adaq8092_test *priv = context;
+
+	priv->spi_reads++;
+
+	/* RESET is write-only and reads back undefined data */
+	if (reg == ADAQ8092_REG_RESET)
+		*val = 0xA5;
+	else
+		*val = priv->regs[reg];
+
+	return 0;
+}
+
+static int adaq8092_test_reg_write(void *context, unsigned int reg,
+				   unsigned int val)
+{
+	struct adaq8092_test *priv = context;
+
+	priv->spi_writes++;
+
+	/* The reset bit self-clears and restores the register defaults */
+	if (reg == ADAQ8092_REG_RESET && (val & ADAQ8092_RESET))
+		memset(priv->regs, 0, sizeof(priv->regs));
+	else
+		priv->regs[reg] = val;
+
+	return 0;
+}
+
+static void adaq8092_test_clear_counts(struct adaq8092_test *priv)
+{
+	priv->spi_reads = 0;
+	priv->spi_writes = 0;
+	priv->axi_reads = 0;
+	priv->axi_writes = 0;
+}
+
+static unsigned int adaq8092_test_field(struct adaq8092_test *priv,
+					unsigned int reg, unsigned int mask)
+{
+	return (priv->regs[reg] & mask) >> __ffs(mask);
+}
+
+static void adaq8092_test_buffer_enable(struct adaq8092_test *priv)
+{
+	to_iio_dev_opaque(priv->indio_dev)->currentmode = INDIO_BUFFER_HARDWARE;
+}
+
+static int adaq8092_test_init(struct kunit *test)
+{
+	struct regmap_config config = adaq8092_regmap_config;
+	struct axiadc_state *axi_adc_st;
+	struct adaq8092_test *priv;
+	struct adaq8092_state *st;
+	struct device *dev;
+
+	priv = kunit_kzalloc(test, sizeof(*priv), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, priv);
+	test->priv = priv;
+
+	dev = kunit_device_register(test, "adaq8092-test");
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, dev);
+
+	/* The fake converter carries an axiadc_state like cf_axi_adc does */
+	priv->indio_dev = devm_iio_device_alloc(dev, sizeof(struct axiadc_state));
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, priv->indio_dev);
+
+	st = kunit_kzalloc(test, sizeof(*st), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, st);
+
+	st->spi = kunit_kzalloc(test, sizeof(*st->spi), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, st->spi);
+
+	config.reg_read = adaq8092_test_reg_read;
+	config.reg_write = adaq8092_test_reg_write;
+	st->regmap = devm_regmap_init(dev, NULL, priv, &config);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, st->regmap);
+
+	mutex_init(&st->lock);
+	st->dout_mode = ADAQ8092_DOUBLE_RATE_LVDS;
+	st->twos_comp = ADAQ8092_TWOS_COMPLEMENT;
+	st->calibscale[0] = MICRO;
+	st->calibscale[1] = MICRO;
+	st->axi_ops = &adaq8092_test_axi_ops;
+	priv->st = st;
+
+	priv->conv.chip_info = &conv_chip_info;
+	priv->conv.phy = st;
+	iio_device_set_drvdata(priv->indio_dev, &priv->conv);
+	axi_adc_st = iio_priv(priv->indio_dev);
+	axi_adc_st->regs = (void __iomem __force *)priv->axi;
+
+	/* The interface reports locked as soon as it leaves reset */
+	priv->axi[ADI_REG_STATUS / 4] = ADI_STATUS;
+
+	return 0;
+}
+
+struct adaq8092_enum_case {
+	const char			*name;
+	const struct iio_enum		*e;
+	unsigned int			mode;
+	unsigned int			reg;
+	unsigned int			mask;
+	/* Register traffic of one set, the regmap has no cache */
+	unsigned int			spi_xfers;
+	unsigned int			axi_accesses;
+};
+
+static const struct adaq8092_enum_case adaq8092_enum_cases[] = {
+	{ "pd_mode", &adaq8092_pd_mode_enum, ADAQ8092_CH1_CH2_NAP,
+	  ADAQ8092_REG_POWERDOWN, ADAQ8092_POWERDOWN_MODE, 2, 0 },
+	{ "clk_pol_mode", &adaq8092_clk_pol_mode_enum, ADAQ8092_CLK_POL_INVERTED,
+	  ADAQ8092_REG_TIMING, ADAQ8092_CLK_INVERT, 2, 0 },
+	{ "clk_phase_mode", &adaq8092_clk_phase_mode_enum,
+	  ADAQ8092_CLKOUT_DELAY_180DEG, ADAQ8092_REG_TIMING, ADAQ8092_CLK_PHASE,
+	  2, 0 },
+	{ "clk_dc_mode", &adaq8092_clk_dc_mode_enum, ADAQ8092_CLK_DC_STABILIZER_ON,
+	  ADAQ8092_REG_TIMING, ADAQ8092_CLK_DUTYCYCLE, 2, 0 },
+	{ "lvds_cur_mode", &adaq8092_lvds_cur_mode_enum, ADAQ8092_1M75,
+	  ADAQ8092_REG_OUTPUT_MODE, ADAQ8092_ILVDS, 2, 0 },
+	{ "lvds_term_mode", &adaq8092_lvds_term_mode_enum, ADAQ8092_TERM_ON,
+	  ADAQ8092_REG_OUTPUT_MODE, ADAQ8092_TERMON, 2, 0 },
+	{ "dout_en", &adaq8092_dout_en_enum, ADAQ8092_DOUT_OFF,
+	  ADAQ8092_REG_OUTPUT_MODE, ADAQ8092_OUTOFF, 2, 0 },
+	{ "test_mode", &adaq8092_test_mode_enum, ADAQ8092_TEST_CHECKERBOARD,
+	  ADAQ8092_REG_DATA_FORMAT, ADAQ8092_OUTTEST, 2, 0 },
+	/* Read-modify-write of both channel controls and the core control */
+	{ "alt_bit_pol_en", &adaq8092_alt_pol_en_enum, ADAQ8092_ALT_BIT_POL_ON,
+	  ADAQ8092_REG_DATA_FORMAT, ADAQ8092_ABP, 2, 6 },
+	{ "data_rand_en", &adaq8092_data_rand_en_enum, ADAQ8092_DATA_RAND_ON,
+	  ADAQ8092_REG_DATA_FORMAT, ADAQ8092_RAND, 2, 2 },
+	/* Read-modify-write of both channel controls */
+	{ "twos_complement", &adaq8092_twoscomp_enum, ADAQ8092_TWOS_COMPLEMENT,
+	  ADAQ8092_REG_DATA_FORMAT, ADAQ8092_TWOSCOMP, 2, 4 },
+};
+
+static void adaq8092_enum_case_desc(const struct adaq8092_enum_case *c,
+				    char *desc)
+{
+	strscpy(desc, c->name, KUNIT_PARAM_DESC_SIZE);
+}
+
+KUNIT_ARRAY_PARAM(adaq8092_enum, adaq8092_enum_cases, adaq8092_enum_case_desc);
+
+static void adaq8092_test_enum_set(struct kunit *test)
+{
+	const struct adaq8092_enum_case *c = test->param_value;
+	struct adaq8092_test *priv = test->priv;
+	unsigned int other;
+
+	other = priv->regs[c->reg] & ~c->mask;
+
+	KUNIT_ASSERT_EQ(test, c->e->set(priv->indio_dev, NULL, c->mode), 0);
+
+	KUNIT_EXPECT_EQ(test, adaq8092_test_field(priv, c->reg, c->mask), c->mode);
+	KUNIT_EXPECT_EQ(test, priv->regs[c->reg] & ~c->mask, other);
+	KUNIT_EXPECT_EQ(test, c->e->get(priv->indio_dev, NULL), c->mode);
+	KUNIT_EXPECT_EQ(test, priv->st->reconfig_count, 1);
+	KUNIT_EXPECT_EQ(test, priv->st->realign_count, 0);
+
+	KUNIT_EXPECT_LE(test, priv->spi_reads + priv->spi_writes, c->spi_xfers);
+	KUNIT_EXPECT_LE(test, priv->axi_reads + priv->axi_writes, c->axi_accesses);
+}
+
+static void adaq8092_test_axi_encoding(struct kunit *test)
+{
+	struct adaq8092_test *priv = test->priv;
+	int i;
+
+	KUNIT_ASSERT_EQ(test, adaq8092_alt_pol_en_enum.set(priv->indio_dev, NULL,
+							   ADAQ8092_ALT_BIT_POL_ON), 0);
+	KUNIT_ASSERT_EQ(test, adaq8092_data_rand_en_enum.set(priv->indio_dev, NULL,
+							     ADAQ8092_DATA_RAND_ON), 0);
+
+	KUNIT_EXPECT_EQ(test, priv->axi[ADAQ8092_AXI_REG_CNTRL / 4],
+			ADAQ8092_AXI_ABP | ADAQ8092_AXI_RAND);
+	for (i = 0; i < conv_chip_info.num_channels; i++)
+		KUNIT_EXPECT_TRUE(test, priv->axi[ADI_REG_CHAN_CNTRL(i) / 4] &
+				  ADI_FORMAT_TYPE);
+
+	KUNIT_ASSERT_EQ(test, adaq8092_alt_pol_en_enum.set(priv->indio_dev, NULL,
+							   ADAQ8092_ALT_BIT_POL_OFF), 0);
+
+	KUNIT_EXPECT_EQ(test, priv->axi[ADAQ8092_AXI_REG_CNTRL / 4],
+			ADAQ8092_AXI_RAND);
+	for (i = 0; i < conv_chip_info.num_channels; i++)
+		KUNIT_EXPECT_FALSE(test, priv->axi[ADI_REG_CHAN_CNTRL(i) / 4] &
+				   ADI_FORMAT_TYPE);
+}
+
+/* Attributes that stop the data outputs and DCO, and their running value */
+static const struct {
+	const struct iio_enum		*e;
+	unsigned int			stop;
+	unsigned int			run;
+} adaq8092_dout_stop_cases[] = {
+	{ &adaq8092_pd_mode_enum, ADAQ8092_SLEEP, ADAQ8092_NORMAL_OP },
+	{ &adaq8092_dout_en_enum, ADAQ8092_DOUT_OFF, ADAQ8092_DOUT_ON },
+	{ &adaq8092_pd_gpio_enum, ADAQ8092_PD1_OFF_PD2_OFF,
+	  ADAQ8092_PD1_ON_PD2_ON },
+};
+
+static void adaq8092_test_quiesce(struct kunit *test)
+{
+	struct adaq8092_test *priv = test->priv;
+	int i;
+
+	adaq8092_test_buffer_enable(priv);
+
+	/* Settings that do not disturb the data path leave the core alone */
+	KUNIT_ASSERT_EQ(test, adaq8092_test_mode_enum.set(priv->indio_dev, NULL,
+							  ADAQ8092_TEST_ALTERNATING), 0);
+	KUNIT_EXPECT_EQ(test, priv->axi_reads + priv->axi_writes, 0);
+	KUNIT_EXPECT_EQ(test, priv->st->realign_count, 0);
+
+	adaq8092_test_clear_counts(priv);
+
+	/* Reset assert, release, status poll and both channel status clears */
+	KUNIT_ASSERT_EQ(test, adaq8092_clk_pol_mode_enum.set(priv->indio_dev, NULL,
+							     ADAQ8092_CLK_POL_INVERTED), 0);
+	KUNIT_EXPECT_EQ(test, priv->axi[ADI_REG_RSTN / 4], ADI_MMCM_RSTN | ADI_RSTN);
+	for (i = 0; i < conv_chip_info.num_channels; i++)
+		KUNIT_EXPECT_EQ(test, priv->axi[ADI_REG_CHAN_STATUS(i) / 4], ~0U);
+	KUNIT_EXPECT_EQ(test, priv->axi_writes, 2 + conv_chip_info.num_channels);
+	KUNIT_EXPECT_EQ(test, priv->axi_reads, 1);
+	KUNIT_EXPECT_EQ(test, priv->st->realign_count, 1);
+	KUNIT_EXPECT_EQ(test, priv->st->reconfig_count, 2);
+
+	/* Stopped outputs keep the data path in reset until they run again */
+	for (i = 0; i < ARRAY_SIZE(adaq8092_dout_stop_cases); i++) {
+		const struct iio_enum *e = adaq8092_dout_stop_cases[i].e;
+
+		KUNIT_ASSERT_EQ(test, e->set(priv->indio_dev, NULL,
+					     adaq8092_dout_stop_cases[i].stop), 0);
+		KUNIT_EXPECT_EQ(test, priv->axi[ADI_REG_RSTN / 4], ADI_MMCM_RSTN);
+		KUNIT_EXPECT_EQ(test, priv->st->realign_count, 1 + i);
+
+		KUNIT_ASSERT_EQ(test, e->set(priv->indio_dev, NULL,
+					     adaq8092_dout_stop_cases[i].run), 0);
+		KUNIT_EXPECT_EQ(test, priv->axi[ADI_REG_RSTN / 4],
+				ADI_MMCM_RSTN | ADI_RSTN);
+		KUNIT_EXPECT_EQ(test, priv->st->realign_count, 2 + i);
+	}
+	KUNIT_EXPECT_EQ(test, priv->st->reconfig_count,
+			2 + 2 * ARRAY_SIZE(adaq8092_dout_stop_cases));
+}
+
+static void adaq8092_test_quiesce_timeout(struct kunit *test)
+{
+	struct adaq8092_test *priv = test->priv;
+
+	adaq8092_test_buffer_enable(priv);
+	priv->axi[ADI_REG_STATUS / 4] = 0;
+
+	KUNIT_EXPECT_EQ(test, adaq8092_clk_dc_mode_enum.set(priv->indio_dev, NULL,
+							    ADAQ8092_CLK_DC_STABILIZER_ON),
+			-ETIMEDOUT);
+	KUNIT_EXPECT_EQ(test, priv->st->reconfig_count, 0);
+	KUNIT_EXPECT_FALSE(test, mutex_is_locked(&priv->st->lock));
+}
+
+static void adaq8092_test_dout_mode(struct kunit *test)
+{
+	struct adaq8092_test *priv = test->priv;
+	struct iio_dev *indio_dev = priv->indio_dev;
+
+	/* Crossing LVDS <-> CMOS is refused without a switchable HDL build */
+	KUNIT_EXPECT_EQ(test, adaq8092_dout_mode_enum.set(indio_dev, NULL,
+							  ADAQ8092_FULL_RATE_CMOS),
+			-EINVAL);
+	KUNIT_EXPECT_EQ(test, priv->spi_reads + priv->spi_writes, 0);
+	KUNIT_EXPECT_EQ(test, priv->st->dout_mode, ADAQ8092_DOUBLE_RATE_LVDS);
+	KUNIT_EXPECT_EQ(test, priv->st->reconfig_count, 0);
+	KUNIT_EXPECT_FALSE(test, mutex_is_locked(&priv->st->lock));
+
+	priv->st->dout_switchable = true;
+
+	/* TIMING write, OUTPUT_MODE update and readback */
+	KUNIT_ASSERT_EQ(test, adaq8092_dout_mode_enum.set(indio_dev, NULL,
+							  ADAQ8092_FULL_RATE_CMOS), 0);
+	KUNIT_EXPECT_EQ(test, adaq8092_test_field(priv, ADAQ8092_REG_OUTPUT_MODE,
+						  ADAQ8092_OUTMODE),
+			ADAQ8092_FULL_RATE_CMOS);
+	KUNIT_EXPECT_EQ(test, priv->regs[ADAQ8092_REG_TIMING], 0);
+	KUNIT_EXPECT_TRUE(test, priv->axi[ADI_REG_CNTRL / 4] & BIT(16));
+	KUNIT_EXPECT_TRUE(test, priv->axi[ADAQ8092_AXI_REG_CNTRL / 4] &
+			  ADAQ8092_AXI_CMOS_SEL);
+	KUNIT_EXPECT_LE(test, priv->spi_reads + priv->spi_writes, 4);
+
+	KUNIT_ASSERT_EQ(test, adaq8092_dout_mode_enum.set(indio_dev, NULL,
+							  ADAQ8092_DOUBLE_RATE_LVDS), 0);
+	KUNIT_EXPECT_EQ(test, adaq8092_test_field(priv, ADAQ8092_REG_OUTPUT_MODE,
+						  ADAQ8092_OUTMODE),
+			ADAQ8092_DOUBLE_RATE_LVDS);
+	KUNIT_EXPECT_EQ(test, priv->regs[ADAQ8092_REG_TIMING], ADAQ8092_CLK_INVERT);
+	KUNIT_EXPECT_FALSE(test, priv->axi[ADI_REG_CNTRL / 4] & BIT(16));
+	KUNIT_EXPECT_FALSE(test, priv->axi[ADAQ8092_AXI_REG_CNTRL / 4] &
+			   ADAQ8092_AXI_CMOS_SEL);
+
+	/* Timing from the device tree is kept across mode switches */
+	priv->st->timing_fixed = true;
+	priv->regs[ADAQ8092_REG_TIMING] = ADAQ8092_CLK_DUTYCYCLE;
+	KUNIT_ASSERT_EQ(test, adaq8092_dout_mode_enum.set(indio_dev, NULL,
+							  ADAQ8092_DOUBLE_RATE_CMOS), 0);
+	KUNIT_EXPECT_EQ(test, priv->regs[ADAQ8092_REG_TIMING], ADAQ8092_CLK_DUTYCYCLE);
+}
+
+static void adaq8092_test_image(struct kunit *test)
+{
+	struct adaq8092_test *priv = test->priv;
+	struct adaq8092_state *st = priv->st;
+
+	st->pd_mode = ADAQ8092_CH1_NORMAL_CH2_NAP;
+	st->clk_pol_mode = ADAQ8092_CLK_POL_INVERTED;
+	st->clk_phase_mode = ADAQ8092_CLKOUT_DELAY_90DEG;
+	st->lvds_cur_mode = ADAQ8092_2M5A;
+	st->lvds_term_mode = ADAQ8092_TERM_ON;
+	st->test_mode = ADAQ8092_TEST_ZEROS;
+	st->data_rand_en = ADAQ8092_DATA_RAND_ON;
+	st->twos_comp = ADAQ8092_TWOS_COMPLEMENT;
+
+	/* One write per register, no read-modify-write */
+	KUNIT_ASSERT_EQ(test, adaq8092_write_image(st), 0);
+	KUNIT_EXPECT_EQ(test, priv->spi_writes, ADAQ8092_IMAGE_REGS);
+	KUNIT_EXPECT_EQ(test, priv->spi_reads, 0);
+
+	KUNIT_EXPECT_EQ(test, priv->regs[ADAQ8092_REG_POWERDOWN], 0x01);
+	KUNIT_EXPECT_EQ(test, priv->regs[ADAQ8092_REG_TIMING], 0x0C);
+	KUNIT_EXPECT_EQ(test, priv->regs[ADAQ8092_REG_OUTPUT_MODE], 0x59);
+	KUNIT_EXPECT_EQ(test, priv->regs[ADAQ8092_REG_DATA_FORMAT], 0x0B);
+}
+
+static void adaq8092_test_reset(struct kunit *test)
+{
+	struct adaq8092_test *priv = test->priv;
+
+	priv->regs[ADAQ8092_REG_TIMING] = 0x0F;
+	priv->regs[ADAQ8092_REG_DATA_FORMAT] = 0x01;
+
+	/* Reset write, then one poll reading back every register but RESET */
+	KUNIT_ASSERT_EQ(test, adaq8092_reset(priv->st), 0);
+	KUNIT_EXPECT_EQ(test, priv->spi_writes, 1);
+	KUNIT_EXPECT_EQ(test, priv->spi_reads, ADAQ8092_REG_DATA_FORMAT);
+	KUNIT_EXPECT_EQ(test, priv->regs[ADAQ8092_REG_TIMING], 0);
+	KUNIT_EXPECT_EQ(test, priv->regs[ADAQ8092_REG_DATA_FORMAT], 0);
+}
+
+static void adaq8092_test_scale(struct kunit *test)
+{
+	const struct iio_chan_spec *chan = &conv_chip_info.channel[1];
+	struct adaq8092_test *priv = test->priv;
+	int val, val2;
+
+	priv->st->input_range_uv = ADAQ8092_INPUT_RANGE_UV;
+
+	KUNIT_ASSERT_EQ(test, adaq8092_read_raw(priv->indio_dev, chan, &val, &val2,
+						IIO_CHAN_INFO_SCALE),
+			IIO_VAL_FRACTIONAL);
+	KUNIT_EXPECT_EQ(test, val, 2000000);
+	KUNIT_EXPECT_EQ(test, val2, 16384000);
+
+	/* The core converts offset binary, samples stay two's complement */
+	KUNIT_ASSERT_EQ(test, adaq8092_twoscomp_enum.set(priv->indio_dev, NULL,
+							 ADAQ8092_OFFSET_BINARY), 0);
+	KUNIT_ASSERT_EQ(test, adaq8092_read_raw(priv->indio_dev, chan, &val, &val2,
+						IIO_CHAN_INFO_OFFSET), IIO_VAL_INT);
+	KUNIT_EXPECT_EQ(test, val, 0);
+	KUNIT_EXPECT_TRUE(test, priv->axi[ADI_REG_CHAN_CNTRL(1) / 4] &
+			  ADI_FORMAT_TYPE);
+
+	/* Both encodings invert the MSB, together they cancel out */
+	KUNIT_ASSERT_EQ(test, adaq8092_alt_pol_en_enum.set(priv->indio_dev, NULL,
+							   ADAQ8092_ALT_BIT_POL_ON), 0);
+	KUNIT_EXPECT_FALSE(test, priv->axi[ADI_REG_CHAN_CNTRL(1) / 4] &
+			   ADI_FORMAT_TYPE);
+
+	KUNIT_ASSERT_EQ(test, adaq8092_twoscomp_enum.set(priv->indio_dev, NULL,
+							 ADAQ8092_TWOS_COMPLEMENT), 0);
+	KUNIT_ASSERT_EQ(test, adaq8092_read_raw(priv->indio_dev, chan, &val, &val2,
+						IIO_CHAN_INFO_OFFSET), IIO_VAL_INT);
+	KUNIT_EXPECT_EQ(test, val, 0);
+	KUNIT_EXPECT_TRUE(test, priv->axi[ADI_REG_CHAN_CNTRL(1) / 4] &
+			  ADI_FORMAT_TYPE);
+}
+
+static void adaq8092_test_calib(struct kunit *test)
+{
+	const struct iio_chan_spec *chan = &conv_chip_info.channel[1];
+	struct adaq8092_test *priv = test->priv;
+	struct iio_dev *indio_dev = priv->indio_dev;
+	int val, val2;
+
+	KUNIT_ASSERT_EQ(test, adaq8092_write_raw(indio_dev, chan, -100, 0,
+						 IIO_CHAN_INFO_CALIBBIAS), 0);
+	KUNIT_ASSERT_EQ(test, adaq8092_write_raw(indio_dev, chan, 1, 500000,
+						 IIO_CHAN_INFO_CALIBSCALE), 0);
+
+	KUNIT_EXPECT_EQ(test, priv->axi[ADI_REG_CHAN_CNTRL_1(1) / 4],
+			ADI_DCFILT_OFFSET(-100));
+	KUNIT_EXPECT_EQ(test, priv->axi[ADI_REG_CHAN_CNTRL_2(1) / 4],
+			ADI_IQCOR_COEFF_1(0x6000));
+	KUNIT_EXPECT_EQ(test, priv->axi[ADI_REG_CHAN_CNTRL(1) / 4],
+			ADI_DCFILT_ENB | ADI_IQCOR_ENB);
+	KUNIT_EXPECT_EQ(test, priv->axi[ADI_REG_CHAN_CNTRL(0) / 4], 0);
+
+	KUNIT_ASSERT_EQ(test, adaq8092_read_raw(indio_dev, chan, &val, &val2,
+						IIO_CHAN_INFO_CALIBSCALE),
+			IIO_VAL_INT_PLUS_MICRO);
+	KUNIT_EXPECT_EQ(test, val, 1);
+	KUNIT_EXPECT_EQ(test, val2, 500000);
+
+	/* Neutral values bypass the correction again */
+	KUNIT_ASSERT_EQ(test, adaq8092_write_raw(indio_dev, chan, 0, 0,
+						 IIO_CHAN_INFO_CALIBBIAS), 0);
+	KUNIT_ASSERT_EQ(test, adaq8092_write_raw(indio_dev, chan, 1, 0,
+						 IIO_CHAN_INFO_CALIBSCALE), 0);
+	KUNIT_EXPECT_EQ(test, priv->axi[ADI_REG_CHAN_CNTRL(1) / 4], 0);
+
+	KUNIT_EXPECT_EQ(test, adaq8092_write_raw(indio_dev, chan, 8192, 0,
+						 IIO_CHAN_INFO_CALIBBIAS), -EINVAL);
+	KUNIT_EXPECT_EQ(test, adaq8092_write_raw(indio_dev, chan, 2, 0,
+						 IIO_CHAN_INFO_CALIBSCALE), -EINVAL);
+
+	/* The largest scale still fits the signed coefficient */
+	KUNIT_ASSERT_EQ(test, adaq8092_write_raw(indio_dev, chan, 1, 999938,
+						 IIO_CHAN_INFO_CALIBSCALE), 0);
+	KUNIT_EXPECT_EQ(test, priv->axi[ADI_REG_CHAN_CNTRL_2(1) / 4],
+			ADI_IQCOR_COEFF_1(0x7FFF));
+	KUNIT_EXPECT_EQ(test, adaq8092_write_raw(indio_dev, chan, 1, 999939,
+						 IIO_CHAN_INFO_CALIBSCALE), -EINVAL);
+}
+
+static void adaq8092_test_link_monitor(struct kunit *test)
+{
+	struct adaq8092_test *priv = test->priv;
+	struct adaq8092_state *st = priv->st;
+
+	st->indio_dev = priv->indio_dev;
+
+	/* PN flags only count when the checker follows the link */
+	priv->axi[ADI_REG_CHAN_STATUS(1) / 4] = ADI_PN_ERR;
+	adaq8092_link_check(st);
+	KUNIT_EXPECT_EQ(test, st->link_errors[0], 0);
+	KUNIT_EXPECT_EQ(test, st->link_errors[1], 0);
+	KUNIT_EXPECT_EQ(test, priv->axi_writes, 0);
+
+	st->pn_monitor = true;
+	adaq8092_link_check(st);
+	KUNIT_EXPECT_EQ(test, st->link_errors[0], 0);
+	KUNIT_EXPECT_EQ(test, st->link_errors[1], 1);
+	/* Only the flag that was seen is cleared */
+	KUNIT_EXPECT_EQ(test, priv->axi_writes, 1);
+	KUNIT_EXPECT_EQ(test, priv->axi[ADI_REG_CHAN_STATUS(1) / 4], ADI_PN_ERR);
+
+	/* A lost interface lock hits every channel */
+	priv->axi[ADI_REG_CHAN_STATUS(1) / 4] = 0;
+	priv->axi[ADI_REG_STATUS / 4] = 0;
+	adaq8092_link_check(st);
+	KUNIT_EXPECT_EQ(test, st->link_errors[0], 1);
+	KUNIT_EXPECT_EQ(test, st->link_errors[1], 2);
+	KUNIT_EXPECT_EQ(test, st->over_range[0], 0);
+	KUNIT_EXPECT_EQ(test, st->over_range[1], 0);
+
+	/* Over-range is counted apart from link errors, PN monitor or not */
+	st->pn_monitor = false;
+	priv->axi[ADI_REG_STATUS / 4] = ADI_STATUS;
+	priv->axi[ADI_REG_CHAN_STATUS(0) / 4] = ADI_OVER_RANGE | ADI_PN_ERR;
+	priv->axi_writes = 0;
+	adaq8092_link_check(st);
+	KUNIT_EXPECT_EQ(test, st->over_range[0], 1);
+	KUNIT_EXPECT_EQ(test, st->over_range[1], 0);
+	KUNIT_EXPECT_EQ(test, st->link_errors[0], 1);
+	KUNIT_EXPECT_EQ(test, priv->axi_writes, 1);
+	KUNIT_EXPECT_EQ(test, priv->axi[ADI_REG_CHAN_STATUS(0) / 4],
+			ADI_OVER_RANGE);
+}
+
+/* Time and register traffic per set, printed for comparison across changes */
+static void adaq8092_test_bench_setters(struct kunit *test)
+{
+	struct adaq8092_test *priv = test->priv;
+	const struct adaq8092_enum_case *c;
+	unsigned int i, n;
+	ktime_t start;
+	u64 ns;
+
+	adaq8092_test_buffer_enable(priv);
+
+	for (i = 0; i < ARRAY_SIZE(adaq8092_enum_cases); i++) {
+		c = &adaq8092_enum_cases[i];
+		adaq8092_test_clear_counts(priv);
+
+		start = ktime_get();
+		for (n = 0; n < ADAQ8092_TEST_BENCH_LOOPS; n++)
+			KUNIT_ASSERT_EQ(test, c->e->set(priv->indio_dev, NULL,
+							n & 1 ? c->mode : 0), 0);
+		ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+		kunit_info(test, "%-16s %6llu ns/set %3u SPI %3u AXI\n", c->name,
+			   div_u64(ns, ADAQ8092_TEST_BENCH_LOOPS),
+			   (priv->spi_reads + priv->spi_writes) / ADAQ8092_TEST_BENCH_LOOPS,
+			   (priv->axi_reads + priv->axi_writes) / ADAQ8092_TEST_BENCH_LOOPS);
+	}
+}
+
+static struct kunit_case adaq8092_test_cases[] = {
+	KUNIT_CASE_PARAM(adaq8092_test_enum_set, adaq8092_enum_gen_params),
+	KUNIT_CASE(adaq8092_test_axi_encoding),
+	KUNIT_CASE(adaq8092_test_quiesce),
+	KUNIT_CASE(adaq8092_test_quiesce_timeout),
+	KUNIT_CASE(adaq8092_test_dout_mode),
+	KUNIT_CASE(adaq8092_test_image),
+	KUNIT_CASE(adaq8092_test_reset),
+	KUNIT_CASE(adaq8092_test_scale),
+	KUNIT_CASE(adaq8092_test_calib),
+	KUNIT_CASE(adaq8092_test_link_monitor),
+	KUNIT_CASE_SLOW(adaq8092_test_bench_setters),
+	{ }
+};
+
+static struct kunit_suite adaq8092_test_suite = {
+	.name = "adaq8092",
+	.init = adaq8092_test_init,
+	.test_cases = adaq8092_test_cases,
+};
+kunit_test_suite(adaq8092_test_suite);
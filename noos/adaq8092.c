@@ -40,16 +40,72 @@
 /******************************************************************************/
 /***************************** Include Files **********************************/
 /******************************************************************************/
+#ifndef ADAQ8092_STATIC_ALLOC
 #include <stdlib.h>
+#endif
 #include <errno.h>
 #include "adaq8092.h"
 #include "no-os/delay.h"
 
+/******************************************************************************/
+/************************ Variable Declarations *******************************/
+/******************************************************************************/
+/* SPI clock steps tried by adaq8092_spi_autotune(), in ascending order */
+static const uint32_t adaq8092_spi_speeds[] = {
+	1000000, 2000000, 5000000, 10000000, 12500000, 16666666, 20000000,
+	ADAQ8092_SPI_MAX_SPEED_HZ
+};
+
+/*
+ * Readback patterns as {TIMING, OUTTEST}, toggling every TIMING bit and every
+ * test pattern bit. OUTPUT_MODE is left alone, so the outputs stay in their
+ * configured state and no reserved OUTMODE value is ever written.
+ */
+static const uint8_t adaq8092_spi_patterns[][2] = {
+	{0x0A, ADAQ8092_TEST_CHECKERBOARD},
+	{0x05, ADAQ8092_TEST_ZEROS},
+	{0x0F, ADAQ8092_TEST_ALTERNATING},
+	{0x00, ADAQ8092_TEST_OFF}
+};
+
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 /******************************************************************************/
 
+/**
+ * @brief Switch the SPI clock, through the platform SPI init.
+ *
+ * The platform drivers only apply the clock when the descriptor is
+ * initialized, so the descriptor is re-initialized when the rate changes.
+ * @param dev - The device structure.
+ * @param speed_hz - The SPI clock in Hz.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int adaq8092_spi_set_speed(struct adaq8092_dev *dev, uint32_t speed_hz)
+{
+	struct spi_init_param param = dev->spi_param;
+	int ret;
+
+	/* A failed re-init left no descriptor */
+	if (!dev->spi_desc)
+		return -EIO;
+
+	if (dev->spi_desc->max_speed_hz == speed_hz)
+		return 0;
+
+	ret = spi_remove(dev->spi_desc);
+	if (ret)
+		return ret;
+
+	param.max_speed_hz = speed_hz;
+	ret = spi_init(&dev->spi_desc, &param);
+	if (ret)
+		dev->spi_desc = NULL;
+
+	return ret;
+}
+
 /**
  * @brief Read device register.
  * @param dev - The device structure.
@@ -60,8 +116,15 @@
 int adaq8092_read(struct adaq8092_dev *dev, uint8_t reg_addr, uint8_t *reg_data)
 {
 	int ret;
+	uint32_t speed_hz;
 	uint8_t buff[2] = {0};
 
+	speed_hz = dev->spi_speed_hz < ADAQ8092_SPI_READ_MAX_HZ ?
+		   dev->spi_speed_hz : ADAQ8092_SPI_READ_MAX_HZ;
+	ret = adaq8092_spi_set_speed(dev, speed_hz);
+	if (ret)
+		return ret;
+
 	buff[0] = ADAQ8092_SPI_READ | reg_addr;
 
 	ret = spi_write_and_read(dev->spi_desc, buff, 2);
@@ -83,6 +146,11 @@ int adaq8092_read(struct adaq8092_dev *dev, uint8_t reg_addr, uint8_t *reg_data)
 int adaq8092_write(struct adaq8092_dev *dev, uint8_t reg_addr, uint8_t reg_data)
 {
 	uint8_t buff[2] = {0};
+	int ret;
+
+	ret = adaq8092_spi_set_speed(dev, dev->spi_speed_hz);
+	if (ret)
+		return ret;
 
 	buff[0] = reg_addr;
 	buff[1] = reg_data;
@@ -115,136 +183,375 @@ int adaq8092_update_bits(struct adaq8092_dev *dev, uint8_t reg_addr,
 }
 
 /**
- * @brief Initialize the device.
- * @param device - The device structure.
- * @param init_param - The structure that contains the device initial
- * 		       parameters.
+ * @brief Build the register image of the configuration held in the device
+ * 	  structure.
+ * @param dev - The device structure.
+ * @param image - Register address and value pairs, ADAQ8092_IMAGE_REGS long.
+ */
+static void adaq8092_build_image(struct adaq8092_dev *dev,
+				 uint8_t image[][2])
+{
+	image[0][0] = ADAQ8092_REG_POWERDOWN;
+	image[0][1] = field_prep(ADAQ8092_POWERDOWN_MODE, dev->pd_mode);
+
+	image[1][0] = ADAQ8092_REG_TIMING;
+	image[1][1] = field_prep(ADAQ8092_CLK_INVERT, dev->clk_pol_mode) |
+		      field_prep(ADAQ8092_CLK_PHASE, dev->clk_phase_mode) |
+		      field_prep(ADAQ8092_CLK_DUTYCYCLE, dev->clk_dc_mode);
+
+	image[2][0] = ADAQ8092_REG_OUTPUT_MODE;
+	image[2][1] = field_prep(ADAQ8092_ILVDS, dev->lvds_cur_mode) |
+		      field_prep(ADAQ8092_TERMON, dev->lvds_term_mode) |
+		      field_prep(ADAQ8092_OUTOFF, dev->dout_en) |
+		      field_prep(ADAQ8092_OUTMODE, dev->dout_mode);
+
+	image[3][0] = ADAQ8092_REG_DATA_FORMAT;
+	image[3][1] = field_prep(ADAQ8092_OUTTEST, dev->test_mode) |
+		      field_prep(ADAQ8092_ABP, dev->alt_bit_pol_en) |
+		      field_prep(ADAQ8092_RAND, dev->data_rand_en) |
+		      field_prep(ADAQ8092_TWOSCOMP, dev->twos_comp);
+}
+
+/**
+ * @brief Write the configuration held in the device structure.
+ *
+ * Every configuration register is written once from the cached modes, instead
+ * of one read-modify-write per setting.
+ * @param dev - The device structure.
  * @return 0 in case of success, negative error code otherwise.
  */
-int adaq8092_init(struct adaq8092_dev **device,
-		  struct adaq8092_init_param init_param)
+int adaq8092_write_image(struct adaq8092_dev *dev)
 {
-	struct adaq8092_dev *dev;
 	int ret;
+	unsigned int i;
+	uint8_t image[ADAQ8092_IMAGE_REGS][2];
 
-	dev = (struct adaq8092_dev *)calloc(1, sizeof(*dev));
-	if (!dev)
-		return -ENOMEM;
+	adaq8092_build_image(dev, image);
 
-	/* SPI Initialization*/
-	ret = spi_init(&dev->spi_desc, init_param.spi_init);
-	if (ret)
-		goto error_dev;
+	for (i = 0; i < ADAQ8092_IMAGE_REGS; i++) {
+		ret = adaq8092_write(dev, image[i][0], image[i][1]);
+		if (ret)
+			return ret;
+	}
 
-	/* GPIO Initialization */
-	ret = gpio_get(&dev->gpio_adc_pd1, init_param.gpio_adc_pd1_param);
-	if (ret)
-		goto error_spi;
+	return 0;
+}
 
-	ret = gpio_get(&dev->gpio_adc_pd2, init_param.gpio_adc_pd2_param);
-	if (ret)
-		goto error_adc_pd1;
+/**
+ * @brief Check for a powered part already holding the intended configuration.
+ *
+ * After a soft reboot the supply and power down pins may still be driven high
+ * and the registers still programmed, in which case init can skip the power
+ * cycle and the reset.
+ * @param dev - The device structure, with the intended modes filled in.
+ * @return true if the part is configured, false otherwise.
+ */
+static bool adaq8092_is_configured(struct adaq8092_dev *dev)
+{
+	static const uint8_t mask[ADAQ8092_IMAGE_REGS] = {
+		ADAQ8092_POWERDOWN_MODE, GENMASK(3, 0), GENMASK(6, 0), GENMASK(5, 0)
+	};
+	struct gpio_desc *pwr[] = {
+		dev->gpio_en_1p8, dev->gpio_adc_pd1, dev->gpio_adc_pd2
+	};
+	uint8_t image[ADAQ8092_IMAGE_REGS][2];
+	uint8_t dir, val;
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(pwr); i++) {
+		if (gpio_get_direction(pwr[i], &dir) || dir != GPIO_OUT)
+			return false;
+
+		if (gpio_get_value(pwr[i], &val) || val != GPIO_HIGH)
+			return false;
+	}
+
+	/* Serial programming mode */
+	if (gpio_get_direction(dev->gpio_par_ser, &dir) || dir != GPIO_OUT ||
+	    gpio_get_value(dev->gpio_par_ser, &val) || val != GPIO_LOW)
+		return false;
+
+	adaq8092_build_image(dev, image);
+
+	for (i = 0; i < ADAQ8092_IMAGE_REGS; i++) {
+		if (adaq8092_read(dev, image[i][0], &val))
+			return false;
+
+		if ((val ^ image[i][1]) & mask[i])
+			return false;
+	}
+
+	return true;
+}
 
-	ret = gpio_get(&dev->gpio_en_1p8, init_param.gpio_en_1p8_param);
-	if (ret)
-		goto error_adc_pd2;
+/**
+ * @brief Software reset the device and wait for completion.
+ *
+ * Polls until the configuration registers read back their 0x00 reset defaults,
+ * instead of a fixed delay. RESET itself is write-only and reads back
+ * undefined data, so it is not polled. The poll time is kept in dev->reset_us.
+ * @param dev - The device structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_reset(struct adaq8092_dev *dev)
+{
+	int ret;
+	uint8_t reg, val;
+	uint32_t elapsed;
 
-	ret = gpio_get(&dev->gpio_par_ser, init_param.gpio_par_ser_param);
+	ret = adaq8092_write(dev, ADAQ8092_REG_RESET,
+			     field_prep(ADAQ8092_RESET, 1));
 	if (ret)
-		goto error_en_1p8;
+		return ret;
+
+	for (elapsed = 0; elapsed <= ADAQ8092_RESET_TIMEOUT_US;
+	     elapsed += ADAQ8092_RESET_POLL_US) {
+		for (reg = ADAQ8092_REG_POWERDOWN; reg <= ADAQ8092_REG_DATA_FORMAT;
+		     reg++) {
+			ret = adaq8092_read(dev, reg, &val);
+			if (ret)
+				return ret;
+
+			if (val)
+				break;
+		}
+
+		if (reg > ADAQ8092_REG_DATA_FORMAT) {
+			dev->reset_us = elapsed;
+			return 0;
+		}
+
+		udelay(ADAQ8092_RESET_POLL_US);
+	}
+
+	return -ETIMEDOUT;
+}
+
+/**
+ * @brief Power cycle and reset the device.
+ * @param dev - The device structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int adaq8092_powerup(struct adaq8092_dev *dev)
+{
+	int ret;
 
 	/* Powerup Sequence */
 	ret = gpio_direction_output(dev->gpio_adc_pd1, GPIO_LOW);
 	if (ret)
-		goto error_par_ser;
+		return ret;
 
 	ret = gpio_direction_output(dev->gpio_adc_pd2, GPIO_LOW);
 	if (ret)
-		goto error_par_ser;
+		return ret;
 
 	ret = gpio_direction_output(dev->gpio_en_1p8, GPIO_LOW);
 	if (ret)
-		goto error_par_ser;
+		return ret;
 
 	ret = gpio_direction_output(dev->gpio_par_ser, GPIO_LOW);
 	if (ret)
-		goto error_par_ser;
+		return ret;
 
 	mdelay(1000);
 
 	ret = gpio_set_value(dev->gpio_en_1p8, GPIO_HIGH);
 	if (ret)
-		goto error_par_ser;
+		return ret;
 
 	mdelay(500);
 
 	ret = gpio_set_value(dev->gpio_adc_pd1, GPIO_HIGH);
 	if (ret)
-		goto error_par_ser;
+		return ret;
 
 	mdelay(1);
 
 	ret = gpio_set_value(dev->gpio_adc_pd2, GPIO_HIGH);
 	if (ret)
-		goto error_par_ser;
+		return ret;
 
-	/* Software Reset */
-	ret = adaq8092_write(dev,  ADAQ8092_REG_RESET, field_prep(ADAQ8092_RESET, 1));
-	if (ret)
-		goto error_par_ser;
+	return adaq8092_reset(dev);
+}
 
-	mdelay(100);
+/**
+ * @brief Write and read back the test patterns at the current SPI clock.
+ * @param dev - The device structure.
+ * @param data_format - DATA_FORMAT value the test pattern field is merged into.
+ * @return 0 if every pattern reads back, negative error code otherwise.
+ */
+static int adaq8092_spi_verify(struct adaq8092_dev *dev, uint8_t data_format)
+{
+	int ret;
+	unsigned int i, j;
+	uint8_t timing, format, expected;
+
+	for (i = 0; i < ADAQ8092_SPI_AUTOTUNE_PASSES; i++) {
+		for (j = 0; j < ARRAY_SIZE(adaq8092_spi_patterns); j++) {
+			expected = (data_format & ~ADAQ8092_OUTTEST) |
+				   field_prep(ADAQ8092_OUTTEST,
+					      adaq8092_spi_patterns[j][1]);
+
+			ret = adaq8092_write(dev, ADAQ8092_REG_TIMING,
+					     adaq8092_spi_patterns[j][0]);
+			if (ret)
+				return ret;
+
+			ret = adaq8092_write(dev, ADAQ8092_REG_DATA_FORMAT, expected);
+			if (ret)
+				return ret;
+
+			ret = adaq8092_read(dev, ADAQ8092_REG_TIMING, &timing);
+			if (ret)
+				return ret;
+
+			ret = adaq8092_read(dev, ADAQ8092_REG_DATA_FORMAT, &format);
+			if (ret)
+				return ret;
+
+			if ((timing & GENMASK(3, 0)) != adaq8092_spi_patterns[j][0] ||
+			    (format & GENMASK(5, 0)) != (expected & GENMASK(5, 0)))
+				return -EIO;
+		}
+	}
 
-	/* Device Initialization */
-	ret = adaq8092_set_pd_mode(dev, init_param.pd_mode);
-	if (ret)
-		goto error_par_ser;
+	return 0;
+}
 
-	ret = adaq8092_set_clk_pol_mode(dev, init_param.clk_pol_mode);
-	if (ret)
-		goto error_par_ser;
+/**
+ * @brief Select the fastest SPI clock that passes register readback.
+ *
+ * Steps the SPI clock up through adaq8092_spi_speeds[] until max_hz or the
+ * first readback failure, then settles one step below the fastest passing
+ * rate for margin. Only writes run at the tuned clock, the readback stays
+ * within ADAQ8092_SPI_READ_MAX_HZ. TIMING and DATA_FORMAT are restored
+ * afterwards.
+ * @param dev - The device structure.
+ * @param max_hz - Upper bound for the SPI clock in Hz.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_spi_autotune(struct adaq8092_dev *dev, uint32_t max_hz)
+{
+	int ret, good = -1;
+	unsigned int i;
+	uint32_t base_hz;
+	uint8_t timing, data_format;
 
-	ret = adaq8092_set_clk_phase_mode(dev, init_param.clk_phase_mode);
-	if (ret)
-		goto error_par_ser;
+	if (!dev || max_hz < adaq8092_spi_speeds[0])
+		return -EINVAL;
 
-	ret = adaq8092_set_clk_dc_mode(dev, init_param.clk_dc_mode);
-	if (ret)
-		goto error_par_ser;
+	base_hz = dev->spi_speed_hz;
 
-	ret = adaq8092_set_lvds_cur_mode(dev, init_param.lvds_cur_mode);
+	ret = adaq8092_read(dev, ADAQ8092_REG_TIMING, &timing);
 	if (ret)
-		goto error_par_ser;
+		return ret;
 
-	ret = adaq8092_set_lvds_term_mode(dev, init_param.lvds_term_mode);
+	ret = adaq8092_read(dev, ADAQ8092_REG_DATA_FORMAT, &data_format);
 	if (ret)
-		goto error_par_ser;
+		return ret;
 
-	ret = adaq8092_set_dout_en(dev, init_param.dout_en);
-	if (ret)
-		goto error_par_ser;
+	for (i = 0; i < ARRAY_SIZE(adaq8092_spi_speeds); i++) {
+		if (adaq8092_spi_speeds[i] > max_hz)
+			break;
+
+		dev->spi_speed_hz = adaq8092_spi_speeds[i];
+		if (adaq8092_spi_verify(dev, data_format))
+			break;
+
+		good = i;
+	}
+
+	if (good < 0) {
+		dev->spi_speed_hz = base_hz;
+		ret = -EIO;
+	} else {
+		dev->spi_speed_hz = adaq8092_spi_speeds[good ? good - 1 : 0];
+		ret = 0;
+	}
 
-	ret = adaq8092_set_dout_mode(dev, init_param.dout_mode);
+	if (adaq8092_write(dev, ADAQ8092_REG_TIMING, timing) ||
+	    adaq8092_write(dev, ADAQ8092_REG_DATA_FORMAT, data_format))
+		return -EIO;
+
+	return ret;
+}
+
+/**
+ * @brief Initialize the device in caller provided storage.
+ * @param dev - The device structure, statically allocated by the caller.
+ * @param init_param - The structure that contains the device initial
+ * 		       parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_init_static(struct adaq8092_dev *dev,
+			 struct adaq8092_init_param init_param)
+{
+	int ret;
+	bool configured;
+
+	if (!dev)
+		return -EINVAL;
+
+	memset(dev, 0, sizeof(*dev));
+
+	/* SPI Initialization*/
+	ret = spi_init(&dev->spi_desc, init_param.spi_init);
 	if (ret)
-		goto error_par_ser;
+		return ret;
 
-	ret = adaq8092_set_test_mode(dev, init_param.test_mode);
+	dev->spi_param = *init_param.spi_init;
+	dev->spi_speed_hz = dev->spi_desc->max_speed_hz;
+
+	/* GPIO Initialization */
+	ret = gpio_get(&dev->gpio_adc_pd1, init_param.gpio_adc_pd1_param);
 	if (ret)
-		goto error_par_ser;
+		goto error_spi;
 
-	ret = adaq8092_set_alt_pol_en(dev, init_param.alt_bit_pol_en);
+	ret = gpio_get(&dev->gpio_adc_pd2, init_param.gpio_adc_pd2_param);
 	if (ret)
-		goto error_par_ser;
+		goto error_adc_pd1;
 
-	ret = adaq8092_set_data_rand_en(dev, init_param.data_rand_en);
+	ret = gpio_get(&dev->gpio_en_1p8, init_param.gpio_en_1p8_param);
 	if (ret)
-		goto error_par_ser;
+		goto error_adc_pd2;
 
-	ret = adaq8092_set_twos_comp(dev, init_param.twos_comp);
+	ret = gpio_get(&dev->gpio_par_ser, init_param.gpio_par_ser_param);
 	if (ret)
-		goto error_par_ser;
+		goto error_en_1p8;
 
-	*device = dev;
+	/* Device Initialization */
+	dev->pd_mode = init_param.pd_mode;
+	dev->clk_pol_mode = init_param.clk_pol_mode;
+	dev->clk_phase_mode = init_param.clk_phase_mode;
+	dev->clk_dc_mode = init_param.clk_dc_mode;
+	dev->lvds_cur_mode = init_param.lvds_cur_mode;
+	dev->lvds_term_mode = init_param.lvds_term_mode;
+	dev->dout_en = init_param.dout_en;
+	dev->dout_mode = init_param.dout_mode;
+	dev->test_mode = init_param.test_mode;
+	dev->alt_bit_pol_en = init_param.alt_bit_pol_en;
+	dev->data_rand_en = init_param.data_rand_en;
+	dev->twos_comp = init_param.twos_comp;
+
+	/* Warm restart: skip the power cycle and the reset */
+	configured = adaq8092_is_configured(dev);
+	if (!configured) {
+		ret = adaq8092_powerup(dev);
+		if (ret)
+			goto error_par_ser;
+	}
+
+	if (init_param.spi_autotune_max_hz) {
+		ret = adaq8092_spi_autotune(dev, init_param.spi_autotune_max_hz);
+		if (ret)
+			goto error_par_ser;
+	}
+
+	if (!configured) {
+		ret = adaq8092_write_image(dev);
+		if (ret)
+			goto error_par_ser;
+	}
 
 	return 0;
 
@@ -257,25 +564,56 @@ error_adc_pd2:
 error_adc_pd1:
 	gpio_remove(dev->gpio_adc_pd1);
 error_spi:
-	spi_remove(dev->spi_desc);
-error_dev:
-	free(dev);
+	if (dev->spi_desc)
+		spi_remove(dev->spi_desc);
 
 	return ret;
 }
 
+#ifndef ADAQ8092_STATIC_ALLOC
 /**
- * @brief Remove the device and release resources.
- * @param dev - The device structure.
+ * @brief Initialize the device.
+ * @param device - The device structure.
+ * @param init_param - The structure that contains the device initial
+ * 		       parameters.
  * @return 0 in case of success, negative error code otherwise.
  */
-int adaq8092_remove(struct adaq8092_dev *dev)
+int adaq8092_init(struct adaq8092_dev **device,
+		  struct adaq8092_init_param init_param)
 {
+	struct adaq8092_dev *dev;
 	int ret;
 
-	ret = spi_remove(dev->spi_desc);
-	if (ret)
+	dev = (struct adaq8092_dev *)calloc(1, sizeof(*dev));
+	if (!dev)
+		return -ENOMEM;
+
+	ret = adaq8092_init_static(dev, init_param);
+	if (ret) {
+		free(dev);
 		return ret;
+	}
+
+	*device = dev;
+
+	return 0;
+}
+#endif
+
+/**
+ * @brief Release the resources of a device initialized in caller storage.
+ * @param dev - The device structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_remove_static(struct adaq8092_dev *dev)
+{
+	int ret;
+
+	if (dev->spi_desc) {
+		ret = spi_remove(dev->spi_desc);
+		if (ret)
+			return ret;
+	}
 
 	ret = gpio_remove(dev->gpio_adc_pd1);
 	if (ret)
@@ -289,14 +627,28 @@ int adaq8092_remove(struct adaq8092_dev *dev)
 	if (ret)
 		return ret;
 
-	ret = gpio_remove(dev->gpio_par_ser);
+	return gpio_remove(dev->gpio_par_ser);
+}
+
+#ifndef ADAQ8092_STATIC_ALLOC
+/**
+ * @brief Remove the device and release resources.
+ * @param dev - The device structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_remove(struct adaq8092_dev *dev)
+{
+	int ret;
+
+	ret = adaq8092_remove_static(dev);
 	if (ret)
 		return ret;
 
 	free(dev);
 
-	return ret;
+	return 0;
 }
+#endif
 
 /**
  * @brief Set the device powerodown mode.
@@ -42,6 +42,7 @@
 /******************************************************************************/
 /***************************** Include Files **********************************/
 /******************************************************************************/
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 #include "no-os/util.h"
@@ -51,6 +52,11 @@
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
 /******************************************************************************/
+/*
+ * Build with ADAQ8092_STATIC_ALLOC defined to drop the heap based
+ * adaq8092_init()/adaq8092_remove() and use caller provided storage only.
+ */
+
 /* SPI commands */
 #define ADAQ8092_SPI_READ          	BIT(7)
 #define ADAQ8092_ADDR(x)		((x) & 0xFF)
@@ -85,6 +91,19 @@
 #define ADAQ8092_RAND			BIT(1)
 #define ADAQ8092_TWOSCOMP		BIT(0)
 
+/* Software reset completion polling */
+#define ADAQ8092_RESET_POLL_US		10
+#define ADAQ8092_RESET_TIMEOUT_US	100000
+
+/* Registers covered by the configuration image */
+#define ADAQ8092_IMAGE_REGS		4
+
+/* SPI clock autotune: highest rate tried and readback passes per step */
+#define ADAQ8092_SPI_MAX_SPEED_HZ	25000000u
+#define ADAQ8092_SPI_AUTOTUNE_PASSES	16
+/* Register readback is only specified up to 4 MHz (tSCK >= 250 ns) */
+#define ADAQ8092_SPI_READ_MAX_HZ	4000000u
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -149,8 +168,8 @@ enum adaq8092_dout_modes {
 /* ADAQ8092 Digital Test Pattern */
 enum adaq8092_out_test_modes {
 	ADAQ8092_TEST_OFF = 0,
-	ADAQ8092_TEST_ONES = 1,
-	ADAQ8092_TEST_ZEROS = 3,
+	ADAQ8092_TEST_ZEROS = 1,
+	ADAQ8092_TEST_ONES = 3,
 	ADAQ8092_TEST_CHECKERBOARD = 5,
 	ADAQ8092_TEST_ALTERNATING = 7
 };
@@ -196,6 +215,8 @@ struct adaq8092_init_param {
 	enum adaq8092_alt_bit_pol	alt_bit_pol_en;
 	enum adaq8092_data_rand		data_rand_en;
 	enum adaq8092_twoscomp		twos_comp;
+	/** Upper bound for SPI clock autotune in Hz, 0 keeps spi_init rate */
+	uint32_t			spi_autotune_max_hz;
 };
 
 /**
@@ -205,6 +226,8 @@ struct adaq8092_init_param {
 struct adaq8092_dev {
 	/** Device communication descriptor */
 	struct spi_desc			*spi_desc;
+	/** SPI initialization parameters, kept to change the SPI clock */
+	struct spi_init_param		spi_param;
 	struct gpio_desc		*gpio_adc_pd1;
 	struct gpio_desc		*gpio_adc_pd2;
 	struct gpio_desc		*gpio_en_1p8;
@@ -221,6 +244,11 @@ struct adaq8092_dev {
 	enum adaq8092_alt_bit_pol	alt_bit_pol_en;
 	enum adaq8092_data_rand		data_rand_en;
 	enum adaq8092_twoscomp		twos_comp;
+	/** SPI clock used for writes, reads run at ADAQ8092_SPI_READ_MAX_HZ
+	 *  at most */
+	uint32_t			spi_speed_hz;
+	/** Time the last software reset took to complete, polled in us */
+	uint32_t			reset_us;
 };
 
 /******************************************************************************/
@@ -239,12 +267,30 @@ int adaq8092_write(struct adaq8092_dev *dev, uint8_t reg_addr,
 int adaq8092_update_bits(struct adaq8092_dev *dev, uint8_t reg_addr,
 			 uint8_t mask, uint8_t reg_data);
 
+/* Software reset the device and wait for completion. */
+int adaq8092_reset(struct adaq8092_dev *dev);
+
+/* Write the configuration held in the device structure. */
+int adaq8092_write_image(struct adaq8092_dev *dev);
+
+/* Select the fastest SPI clock that passes register readback. */
+int adaq8092_spi_autotune(struct adaq8092_dev *dev, uint32_t max_hz);
+
+/* Initialize the device in caller provided storage. */
+int adaq8092_init_static(struct adaq8092_dev *dev,
+			 struct adaq8092_init_param init_param);
+
+/* Release the resources of a device initialized in caller storage. */
+int adaq8092_remove_static(struct adaq8092_dev *dev);
+
+#ifndef ADAQ8092_STATIC_ALLOC
 /* Initialize the device. */
 int adaq8092_init(struct adaq8092_dev **device,
 		  struct adaq8092_init_param init_param);
 
 /* Remove the device and release resources. */
 int adaq8092_remove(struct adaq8092_dev *dev);
+#endif
 
 /* Set the device powerodown mode. */
 int adaq8092_set_pd_mode(struct adaq8092_dev *dev,
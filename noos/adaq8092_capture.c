@@ -0,0 +1,445 @@
+/***************************************************************************//**
+ *   @file   adaq8092_capture.c
+ *   @brief  Implementation of ADAQ8092 Interrupt Driven Capture.
+ *   @author Antoniu Miclaus (antoniu.miclaus@analog.com)
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#ifndef ADAQ8092_STATIC_ALLOC
+#include <stdlib.h>
+#endif
+#include <string.h>
+#include <errno.h>
+#include "adaq8092_capture.h"
+#include "no-os/util.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief DMA interrupt handler, retires every completed transfer.
+ *
+ * TRANSFER_DONE holds one bit per transfer ID, so transfers completing
+ * back to back before the handler runs are all accounted for.
+ *
+ * @param ctx - The capture structure.
+ * @param event - Unused.
+ * @param extra - Unused.
+ */
+static void adaq8092_capture_isr(void *ctx, uint32_t event, void *extra)
+{
+	struct adaq8092_capture_dev *dev = ctx;
+	uint32_t pending, done, slot;
+
+	(void)event;
+	(void)extra;
+
+	axi_dmac_read(dev->dmac, AXI_DMAC_REG_IRQ_PENDING, &pending);
+	axi_dmac_write(dev->dmac, AXI_DMAC_REG_IRQ_PENDING, pending);
+	dev->irq_count++;
+
+	if (!(pending & AXI_DMAC_IRQ_EOT))
+		return;
+
+	axi_dmac_read(dev->dmac, AXI_DMAC_REG_TRANSFER_DONE, &done);
+	while (dev->completed != dev->submitted) {
+		slot = dev->completed % ADAQ8092_CAPTURE_QUEUE_DEPTH;
+		if (!(done & BIT(dev->id[slot])))
+			break;
+
+		if (dev->complete)
+			dev->complete(dev->ctx, dev->address[slot], dev->bytes[slot]);
+		dev->completed++;
+	}
+}
+
+/**
+ * @brief Initialize the interrupt driven capture in caller provided storage.
+ * @param dev - The capture structure, allocated by the caller.
+ * @param init_param - The structure that contains the initial parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_capture_init_static(struct adaq8092_capture_dev *dev,
+				 struct adaq8092_capture_init_param *init_param)
+{
+	struct callback_desc dma_cb;
+	int ret;
+
+	if (!dev || !init_param->dmac || !init_param->irq_ctrl)
+		return -EINVAL;
+
+	memset(dev, 0, sizeof(*dev));
+	dev->dmac = init_param->dmac;
+	dev->irq_ctrl = init_param->irq_ctrl;
+	dev->irq_id = init_param->irq_id;
+	dev->complete = init_param->complete;
+	dev->ctx = init_param->ctx;
+	dev->dcache_invalidate_range = init_param->dcache_invalidate_range;
+
+	ret = adaq8092_capture_set_mem_mode(dev, init_param->mem_mode);
+	if (ret)
+		return ret;
+
+	/* Only end of transfer is of interest, start of transfer stays masked. */
+	ret = axi_dmac_write(dev->dmac, AXI_DMAC_REG_CTRL,
+			     AXI_DMAC_CTRL_ENABLE);
+	if (ret)
+		return ret;
+
+	ret = axi_dmac_write(dev->dmac, AXI_DMAC_REG_IRQ_MASK,
+			     AXI_DMAC_IRQ_SOT);
+	if (ret)
+		return ret;
+
+	ret = axi_dmac_write(dev->dmac, AXI_DMAC_REG_IRQ_PENDING,
+			     AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT);
+	if (ret)
+		return ret;
+
+	dma_cb.callback = adaq8092_capture_isr;
+	dma_cb.ctx = dev;
+	dma_cb.config = NULL;
+
+	ret = irq_register_callback(dev->irq_ctrl, dev->irq_id, &dma_cb);
+	if (ret)
+		return ret;
+
+	ret = irq_enable(dev->irq_ctrl, dev->irq_id);
+	if (ret)
+		goto error_irq;
+
+	return 0;
+
+error_irq:
+	irq_unregister(dev->irq_ctrl, dev->irq_id);
+
+	return ret;
+}
+
+/**
+ * @brief Stop the capture and release the DMA interrupt.
+ * @param dev - The capture structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_capture_remove_static(struct adaq8092_capture_dev *dev)
+{
+	int ret;
+
+	if (!dev)
+		return -EINVAL;
+
+	ret = irq_disable(dev->irq_ctrl, dev->irq_id);
+	if (ret)
+		return ret;
+
+	ret = irq_unregister(dev->irq_ctrl, dev->irq_id);
+	if (ret)
+		return ret;
+
+	/* Disabling the DMAC also aborts any queued transfer. */
+	ret = axi_dmac_write(dev->dmac, AXI_DMAC_REG_IRQ_MASK,
+			     AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT);
+	if (ret)
+		return ret;
+
+	return axi_dmac_write(dev->dmac, AXI_DMAC_REG_CTRL, 0);
+}
+
+#ifndef ADAQ8092_STATIC_ALLOC
+/**
+ * @brief Initialize the interrupt driven capture.
+ * @param device - The capture structure.
+ * @param init_param - The structure that contains the initial parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_capture_init(struct adaq8092_capture_dev **device,
+			  struct adaq8092_capture_init_param *init_param)
+{
+	struct adaq8092_capture_dev *dev;
+	int ret;
+
+	dev = (struct adaq8092_capture_dev *)calloc(1, sizeof(*dev));
+	if (!dev)
+		return -ENOMEM;
+
+	ret = adaq8092_capture_init_static(dev, init_param);
+	if (ret) {
+		free(dev);
+		return ret;
+	}
+
+	*device = dev;
+
+	return 0;
+}
+
+/**
+ * @brief Remove the interrupt driven capture.
+ * @param dev - The capture structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_capture_remove(struct adaq8092_capture_dev *dev)
+{
+	int ret;
+
+	ret = adaq8092_capture_remove_static(dev);
+	if (ret)
+		return ret;
+
+	free(dev);
+
+	return 0;
+}
+#endif
+
+/**
+ * @brief Queue a transfer without waiting for it.
+ *
+ * The DMAC accepts a new descriptor as soon as the previous one has been
+ * latched, so submitting the next block while the current one is still
+ * being written keeps the stream gapless.
+ *
+ * @param dev - The capture structure.
+ * @param address - Destination buffer, must stay valid until completion.
+ * @param bytes - Transfer size in bytes.
+ * @param seq - Sequence number of the transfer, for adaq8092_capture_wait().
+ * @return 0 in case of success, -EBUSY if the DMAC queue is full, negative
+ *         error code otherwise.
+ */
+int adaq8092_capture_submit(struct adaq8092_capture_dev *dev,
+			    uintptr_t address, uint32_t bytes, uint32_t *seq)
+{
+	uint32_t start, slot;
+	int ret;
+
+	if (!bytes)
+		return -EINVAL;
+
+	if (dev->submitted - dev->completed >= ADAQ8092_CAPTURE_QUEUE_DEPTH)
+		return -EBUSY;
+
+	ret = axi_dmac_read(dev->dmac, AXI_DMAC_REG_START_TRANSFER, &start);
+	if (ret)
+		return ret;
+
+	if (start)
+		return -EBUSY;
+
+	slot = dev->submitted % ADAQ8092_CAPTURE_QUEUE_DEPTH;
+	ret = axi_dmac_read(dev->dmac, AXI_DMAC_REG_TRANSFER_ID,
+			    &dev->id[slot]);
+	if (ret)
+		return ret;
+
+	dev->address[slot] = address;
+	dev->bytes[slot] = bytes;
+
+	ret = axi_dmac_write(dev->dmac, AXI_DMAC_REG_DEST_ADDRESS, address);
+	if (ret)
+		return ret;
+
+	ret = axi_dmac_write(dev->dmac, AXI_DMAC_REG_X_LENGTH, bytes - 1);
+	if (ret)
+		return ret;
+
+	ret = axi_dmac_write(dev->dmac, AXI_DMAC_REG_Y_LENGTH, 0);
+	if (ret)
+		return ret;
+
+	ret = axi_dmac_write(dev->dmac, AXI_DMAC_REG_FLAGS, 0);
+	if (ret)
+		return ret;
+
+	/*
+	 * Publish the transfer before starting it, so the interrupt cannot miss
+	 * its completion. The interrupt stays masked in between, the done bit
+	 * of a reused transfer ID is only cleared by the start.
+	 */
+	ret = irq_disable(dev->irq_ctrl, dev->irq_id);
+	if (ret)
+		return ret;
+
+	if (seq)
+		*seq = dev->submitted;
+	dev->submitted++;
+
+	ret = axi_dmac_write(dev->dmac, AXI_DMAC_REG_START_TRANSFER, 1);
+	if (ret)
+		dev->submitted--;
+
+	irq_enable(dev->irq_ctrl, dev->irq_id);
+
+	return ret;
+}
+
+/**
+ * @brief Check whether a submitted transfer has completed.
+ * @param dev - The capture structure.
+ * @param seq - Sequence number returned by adaq8092_capture_submit().
+ * @return true if the transfer has completed.
+ */
+bool adaq8092_capture_is_done(struct adaq8092_capture_dev *dev, uint32_t seq)
+{
+	/* Wrap safe: seq is done once it falls behind the completed count. */
+	return (int32_t)(dev->completed - seq) > 0;
+}
+
+/**
+ * @brief Wait for a submitted transfer to complete.
+ * @param dev - The capture structure.
+ * @param seq - Sequence number returned by adaq8092_capture_submit().
+ * @param timeout - Maximum number of polls, 0 waits forever.
+ * @return 0 in case of success, -ETIMEDOUT otherwise.
+ */
+int adaq8092_capture_wait(struct adaq8092_capture_dev *dev, uint32_t seq,
+			  uint32_t timeout)
+{
+	while (!adaq8092_capture_is_done(dev, seq)) {
+		if (timeout && !--timeout)
+			return -ETIMEDOUT;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Change how the capture buffers are kept coherent with the CPU caches.
+ *
+ * Mapping the buffers non-cacheable and routing the DMAC through the ACP are
+ * platform setup steps done by the caller, this only selects the matching
+ * maintenance in adaq8092_capture_sync().
+ *
+ * @param dev - The capture structure.
+ * @param mode - The memory mode.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_capture_set_mem_mode(struct adaq8092_capture_dev *dev,
+				  enum adaq8092_capture_mem_mode mode)
+{
+	if (mode > ADAQ8092_CAPTURE_MEM_COHERENT)
+		return -EINVAL;
+
+	if (mode == ADAQ8092_CAPTURE_MEM_INVALIDATE && !dev->dcache_invalidate_range)
+		return -EINVAL;
+
+	dev->mem_mode = mode;
+
+	return 0;
+}
+
+/**
+ * @brief Make a completed transfer visible to the CPU.
+ * @param dev - The capture structure.
+ * @param address - Start of the transferred data.
+ * @param bytes - Number of bytes transferred.
+ */
+void adaq8092_capture_sync(struct adaq8092_capture_dev *dev,
+			   uintptr_t address, uint32_t bytes)
+{
+	if (dev->mem_mode == ADAQ8092_CAPTURE_MEM_INVALIDATE)
+		dev->dcache_invalidate_range(address, bytes);
+}
+
+/**
+ * @brief Capture a contiguous buffer larger than one DMAC transfer.
+ *
+ * The buffer is split in segments that are chained through the DMAC
+ * transfer queue. New segments are queued as soon as a slot frees up, so
+ * the DMAC always has the next descriptor latched when a segment ends and
+ * no samples are dropped between segments.
+ *
+ * @param dev - The capture structure.
+ * @param address - Destination buffer.
+ * @param bytes - Total capture size in bytes.
+ * @param segment_bytes - Size of one segment, 0 selects the largest one.
+ *                        Must be a multiple of the sample frame size.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_capture_chunked(struct adaq8092_capture_dev *dev,
+			     uintptr_t address, uint64_t bytes,
+			     uint32_t segment_bytes)
+{
+	uint32_t seq = dev->submitted, len;
+	uint64_t offset = 0;
+	int ret;
+
+	if (!bytes || segment_bytes > ADAQ8092_CAPTURE_MAX_SEGMENT)
+		return -EINVAL;
+
+	if (!segment_bytes)
+		segment_bytes = ADAQ8092_CAPTURE_MAX_SEGMENT;
+
+	while (offset < bytes) {
+		len = bytes - offset < segment_bytes ? bytes - offset : segment_bytes;
+
+		ret = adaq8092_capture_submit(dev, address + offset, len, &seq);
+		if (ret == -EBUSY)
+			continue;
+		if (ret)
+			return ret;
+
+		offset += len;
+	}
+
+	return adaq8092_capture_wait(dev, seq, 0);
+}
+
+/**
+ * @brief Verify an alternating/checkerboard test pattern capture has no gaps.
+ *
+ * Both patterns toggle every 14-bit output bit from one sample to the next,
+ * so each sample must be the complement of the previous one of the same
+ * channel. Gaps of an even number of samples are not detectable this way.
+ *
+ * @param data - Raw, interleaved samples.
+ * @param nb_samples - Total number of samples.
+ * @param num_ch - Number of interleaved channels.
+ * @return Index of the first discontinuity, -1 if the capture is continuous.
+ */
+int64_t adaq8092_capture_check_alternating(const uint16_t *data,
+		uint64_t nb_samples, uint8_t num_ch)
+{
+	uint64_t i;
+
+	for (i = num_ch; i < nb_samples; i++)
+		if (((data[i] ^ data[i - num_ch]) & 0x3FFF) != 0x3FFF)
+			return i;
+
+	return -1;
+}
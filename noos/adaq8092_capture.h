@@ -0,0 +1,164 @@
+/***************************************************************************//**
+ *   @file   adaq8092_capture.h
+ *   @brief  Header file of ADAQ8092 Interrupt Driven Capture.
+ *   @author Antoniu Miclaus (antoniu.miclaus@analog.com)
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef __ADAQ8092_CAPTURE_H__
+#define __ADAQ8092_CAPTURE_H__
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "axi_dmac.h"
+#include "no-os/irq.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* AXI DMAC transfer queue, one slot per hardware transfer ID */
+#define ADAQ8092_CAPTURE_QUEUE_DEPTH	4
+/* Largest single DMAC transfer, X_LENGTH is 24 bits wide by default */
+#define ADAQ8092_CAPTURE_MAX_SEGMENT	(1 << 24)
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/* ADAQ8092 Capture Buffer Memory Modes */
+enum adaq8092_capture_mem_mode {
+	/** Cacheable buffer, invalidated after every transfer */
+	ADAQ8092_CAPTURE_MEM_INVALIDATE,
+	/** Buffer mapped non-cacheable in the MMU, no maintenance needed */
+	ADAQ8092_CAPTURE_MEM_UNCACHED,
+	/** DMA routed through a cache coherent port (ACP), no maintenance */
+	ADAQ8092_CAPTURE_MEM_COHERENT
+};
+
+/**
+ * @struct adaq8092_capture_init_param
+ * @brief ADAQ8092 Interrupt Driven Capture initialization structure.
+ */
+struct adaq8092_capture_init_param {
+	/** DMA controller of the ADC core */
+	struct axi_dmac		*dmac;
+	/** Initialized interrupt controller */
+	struct irq_ctrl_desc	*irq_ctrl;
+	/** Interrupt line of the DMA controller */
+	uint32_t		irq_id;
+	/** Optional hook, called from interrupt context for each completed block */
+	void (*complete)(void *ctx, uintptr_t address, uint32_t bytes);
+	void			*ctx;
+	/** How the capture buffers are kept coherent with the CPU caches */
+	enum adaq8092_capture_mem_mode	mem_mode;
+	/** Cache invalidation hook, required by ADAQ8092_CAPTURE_MEM_INVALIDATE */
+	void (*dcache_invalidate_range)(uint32_t address, uint32_t bytes_count);
+};
+
+/**
+ * @struct adaq8092_capture_dev
+ * @brief ADAQ8092 Interrupt Driven Capture structure.
+ */
+struct adaq8092_capture_dev {
+	struct axi_dmac		*dmac;
+	struct irq_ctrl_desc	*irq_ctrl;
+	uint32_t		irq_id;
+	void (*complete)(void *ctx, uintptr_t address, uint32_t bytes);
+	void			*ctx;
+	enum adaq8092_capture_mem_mode	mem_mode;
+	void (*dcache_invalidate_range)(uint32_t address, uint32_t bytes_count);
+	/** Queued transfers, indexed by sequence number modulo queue depth */
+	uintptr_t		address[ADAQ8092_CAPTURE_QUEUE_DEPTH];
+	uint32_t		bytes[ADAQ8092_CAPTURE_QUEUE_DEPTH];
+	/** DMAC transfer ID of each queued transfer */
+	uint32_t		id[ADAQ8092_CAPTURE_QUEUE_DEPTH];
+	/** Number of transfers submitted so far */
+	volatile uint32_t	submitted;
+	/** Number of transfers completed so far, updated by the interrupt */
+	volatile uint32_t	completed;
+	/** Number of DMA interrupts serviced */
+	volatile uint32_t	irq_count;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Initialize the interrupt driven capture in caller provided storage. */
+int adaq8092_capture_init_static(struct adaq8092_capture_dev *dev,
+				 struct adaq8092_capture_init_param *init_param);
+
+/* Stop the capture and release the DMA interrupt. */
+int adaq8092_capture_remove_static(struct adaq8092_capture_dev *dev);
+
+#ifndef ADAQ8092_STATIC_ALLOC
+/* Initialize the interrupt driven capture. */
+int adaq8092_capture_init(struct adaq8092_capture_dev **device,
+			  struct adaq8092_capture_init_param *init_param);
+
+/* Remove the interrupt driven capture. */
+int adaq8092_capture_remove(struct adaq8092_capture_dev *dev);
+#endif
+
+/* Queue a transfer without waiting for it. */
+int adaq8092_capture_submit(struct adaq8092_capture_dev *dev,
+			    uintptr_t address, uint32_t bytes, uint32_t *seq);
+
+/* Check whether a submitted transfer has completed. */
+bool adaq8092_capture_is_done(struct adaq8092_capture_dev *dev, uint32_t seq);
+
+/* Wait for a submitted transfer to complete. */
+int adaq8092_capture_wait(struct adaq8092_capture_dev *dev, uint32_t seq,
+			  uint32_t timeout);
+
+/* Change how the capture buffers are kept coherent with the CPU caches. */
+int adaq8092_capture_set_mem_mode(struct adaq8092_capture_dev *dev,
+				  enum adaq8092_capture_mem_mode mode);
+
+/* Make a completed transfer visible to the CPU. */
+void adaq8092_capture_sync(struct adaq8092_capture_dev *dev,
+			   uintptr_t address, uint32_t bytes);
+
+/* Capture a contiguous buffer larger than one DMAC transfer. */
+int adaq8092_capture_chunked(struct adaq8092_capture_dev *dev,
+			     uintptr_t address, uint64_t bytes,
+			     uint32_t segment_bytes);
+
+/* Verify an alternating/checkerboard test pattern capture has no gaps. */
+int64_t adaq8092_capture_check_alternating(const uint16_t *data,
+		uint64_t nb_samples, uint8_t num_ch);
+
+#endif /* __ADAQ8092_CAPTURE_H__ */
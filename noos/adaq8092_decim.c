@@ -0,0 +1,531 @@
+/***************************************************************************//**
+ *   @file   adaq8092_decim.c
+ *   @brief  Implementation of ADAQ8092 Decimation Filter Chain.
+ *   @author Antoniu Miclaus (antoniu.miclaus@analog.com)
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#ifndef ADAQ8092_STATIC_ALLOC
+#include <stdlib.h>
+#endif
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include "adaq8092_decim.h"
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#ifndef M_PI
+#define M_PI	3.14159265358979323846
+#endif
+
+/* Frequency grid used by the compensator design */
+#define ADAQ8092_FIR_DESIGN_GRID	512
+
+/* Fractional bits of the CIC gain normalization multiplier */
+#define ADAQ8092_CIC_NORM_BITS		16
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Saturate a value to the 16-bit output range.
+ * @param val - The value.
+ * @return The saturated value.
+ */
+static int16_t adaq8092_decim_sat16(int64_t val)
+{
+	if (val > INT16_MAX)
+		return INT16_MAX;
+	if (val < INT16_MIN)
+		return INT16_MIN;
+
+	return (int16_t)val;
+}
+
+/**
+ * @brief Normalize a CIC output sample by the exact CIC gain.
+ * @param dev - The decimation structure.
+ * @param val - The comb output.
+ * @return The normalized sample.
+ */
+static int16_t adaq8092_decim_scale(struct adaq8092_decim_dev *dev,
+				    int64_t val)
+{
+	/* The pre-shift keeps the product within 47 bits. */
+	val = (val >> dev->cic_pre_shift) * dev->cic_mult;
+
+	return adaq8092_decim_sat16((val + (1LL << (dev->cic_shift - 1))) >>
+				    dev->cic_shift);
+}
+
+/**
+ * @brief Desired compensator response.
+ * @param f - Frequency, normalized to the CIC output rate.
+ * @param cic_stages - Number of CIC stages.
+ * @param cic_ratio - CIC decimation ratio.
+ * @param fir_ratio - FIR decimation ratio.
+ * @return The desired magnitude.
+ */
+static double adaq8092_decim_fir_resp(double f, uint8_t cic_stages,
+				      uint16_t cic_ratio, uint8_t fir_ratio)
+{
+	double fp = 0.4 / fir_ratio;
+	double fs = 0.5 / fir_ratio;
+	double droop = 1.0;
+
+	if (f >= fs)
+		return 0.0;
+
+	if (cic_ratio > 1 && f > 0.0)
+		droop = pow(fabs(sin(M_PI * f) / (cic_ratio * sin(M_PI * f / cic_ratio))),
+			    cic_stages);
+
+	if (f <= fp)
+		return 1.0 / droop;
+
+	return 0.5 * (1.0 + cos(M_PI * (f - fp) / (fs - fp))) / droop;
+}
+
+/**
+ * @brief Design a Q15 lowpass FIR compensating the CIC passband droop.
+ *
+ * Frequency sampling design with a Hamming window. The passband extends to
+ * 80% of the output Nyquist frequency and the DC gain is unity, the CIC
+ * output being normalized by its exact gain.
+ *
+ * @param taps - The designed coefficients.
+ * @param num_taps - Number of coefficients.
+ * @param cic_stages - Number of CIC stages.
+ * @param cic_ratio - CIC decimation ratio.
+ * @param fir_ratio - FIR decimation ratio.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_decim_design_fir(int16_t *taps, uint16_t num_taps,
+			      uint8_t cic_stages, uint16_t cic_ratio,
+			      uint8_t fir_ratio)
+{
+	double coef[ADAQ8092_FIR_MAX_TAPS];
+	double center, sum = 0.0, h, w;
+	uint16_t n, k;
+
+	if (!num_taps || num_taps > ADAQ8092_FIR_MAX_TAPS || !fir_ratio ||
+	    !cic_ratio)
+		return -EINVAL;
+
+	center = (num_taps - 1) / 2.0;
+
+	for (n = 0; n < num_taps; n++) {
+		h = 0.0;
+		for (k = 0; k <= ADAQ8092_FIR_DESIGN_GRID / 2; k++) {
+			w = (k == 0 || k == ADAQ8092_FIR_DESIGN_GRID / 2) ? 1.0 : 2.0;
+			h += w * adaq8092_decim_fir_resp((double)k / ADAQ8092_FIR_DESIGN_GRID,
+							 cic_stages, cic_ratio, fir_ratio) *
+			     cos(2.0 * M_PI * k * (n - center) / ADAQ8092_FIR_DESIGN_GRID);
+		}
+
+		if (num_taps > 1)
+			h *= 0.54 - 0.46 * cos(2.0 * M_PI * n / (num_taps - 1));
+
+		coef[n] = h;
+		sum += h;
+	}
+
+	for (n = 0; n < num_taps; n++)
+		taps[n] = adaq8092_decim_sat16(lround(coef[n] / sum * 32768.0));
+
+	return 0;
+}
+
+/**
+ * @brief Run the CIC stage over a block.
+ * @param dev - The decimation structure.
+ * @param in - Interleaved input samples.
+ * @param nb_samples - Number of input samples per channel.
+ * @param out - Interleaved output samples, may alias the input.
+ * @return Number of output samples per channel.
+ */
+static uint32_t adaq8092_decim_cic(struct adaq8092_decim_dev *dev,
+				   const int16_t *in, uint32_t nb_samples,
+				   int16_t *out)
+{
+	uint8_t stages = dev->cic_stages;
+	uint32_t i, n = 0;
+	uint8_t s;
+
+	if (dev->cic_ratio == 1) {
+		for (i = 0; i < nb_samples * ADAQ8092_DECIM_NUM_CH; i++)
+			out[i] = adaq8092_decim_scale(dev, in[i]);
+
+		return nb_samples;
+	}
+
+#ifdef __ARM_NEON
+	/* Both channels run in lockstep, one per 64-bit lane. */
+	uint64x2_t integ[ADAQ8092_CIC_MAX_STAGES];
+	uint64x2_t comb[ADAQ8092_CIC_MAX_STAGES];
+	uint64x2_t acc, tmp;
+
+	for (s = 0; s < stages; s++) {
+		integ[s] = vld1q_u64(dev->integ[s]);
+		comb[s] = vld1q_u64(dev->comb[s]);
+	}
+
+	for (i = 0; i < nb_samples; i++) {
+		acc = vreinterpretq_u64_s64(vcombine_s64(vdup_n_s64(in[2 * i]),
+					    vdup_n_s64(in[2 * i + 1])));
+		for (s = 0; s < stages; s++) {
+			integ[s] = vaddq_u64(integ[s], acc);
+			acc = integ[s];
+		}
+
+		if (++dev->cic_phase < dev->cic_ratio)
+			continue;
+
+		dev->cic_phase = 0;
+		for (s = 0; s < stages; s++) {
+			tmp = acc;
+			acc = vsubq_u64(acc, comb[s]);
+			comb[s] = tmp;
+		}
+
+		out[2 * n] = adaq8092_decim_scale(dev,
+						  (int64_t)vgetq_lane_u64(acc, 0));
+		out[2 * n + 1] = adaq8092_decim_scale(dev,
+						      (int64_t)vgetq_lane_u64(acc, 1));
+		n++;
+	}
+
+	for (s = 0; s < stages; s++) {
+		vst1q_u64(dev->integ[s], integ[s]);
+		vst1q_u64(dev->comb[s], comb[s]);
+	}
+#else
+	uint64_t acc, tmp;
+	uint8_t ch;
+
+	for (i = 0; i < nb_samples; i++) {
+		/* Unsigned state gives the modular arithmetic the CIC relies on. */
+		for (ch = 0; ch < ADAQ8092_DECIM_NUM_CH; ch++) {
+			acc = (uint64_t)(int64_t)in[ADAQ8092_DECIM_NUM_CH * i + ch];
+			for (s = 0; s < stages; s++) {
+				dev->integ[s][ch] += acc;
+				acc = dev->integ[s][ch];
+			}
+		}
+
+		if (++dev->cic_phase < dev->cic_ratio)
+			continue;
+
+		dev->cic_phase = 0;
+		for (ch = 0; ch < ADAQ8092_DECIM_NUM_CH; ch++) {
+			acc = dev->integ[stages - 1][ch];
+			for (s = 0; s < stages; s++) {
+				tmp = acc;
+				acc -= dev->comb[s][ch];
+				dev->comb[s][ch] = tmp;
+			}
+
+			out[ADAQ8092_DECIM_NUM_CH * n + ch] =
+				adaq8092_decim_scale(dev, (int64_t)acc);
+		}
+		n++;
+	}
+#endif
+
+	return n;
+}
+
+/**
+ * @brief Compute one FIR output from a contiguous delay line window.
+ * @param hist - Oldest to newest samples.
+ * @param taps - Time-reversed Q15 coefficients.
+ * @param num_taps - Number of coefficients, a multiple of four.
+ * @return The filtered sample.
+ */
+static int16_t adaq8092_decim_fir_dot(const int16_t *hist, const int16_t *taps,
+				      uint16_t num_taps)
+{
+	int64_t val = 0;
+	uint16_t i;
+
+#ifdef __ARM_NEON
+	/* Products fit 32 bits, their sum is widened like the scalar path. */
+	int64x2_t acc = vdupq_n_s64(0);
+
+	for (i = 0; i < num_taps; i += 4)
+		acc = vpadalq_s32(acc, vmull_s16(vld1_s16(&hist[i]),
+						 vld1_s16(&taps[i])));
+
+	val = vgetq_lane_s64(acc, 0) + vgetq_lane_s64(acc, 1);
+#else
+	for (i = 0; i < num_taps; i++)
+		val += (int32_t)hist[i] * taps[i];
+#endif
+
+	return adaq8092_decim_sat16((val + (1 << 14)) >> 15);
+}
+
+/**
+ * @brief Run the FIR stage over a block, evaluating only retained outputs.
+ * @param dev - The decimation structure.
+ * @param in - Interleaved input samples.
+ * @param nb_samples - Number of input samples per channel.
+ * @param out - Interleaved output samples, may alias the input.
+ * @return Number of output samples per channel.
+ */
+static uint32_t adaq8092_decim_fir(struct adaq8092_decim_dev *dev,
+				   const int16_t *in, uint32_t nb_samples,
+				   int16_t *out)
+{
+	uint16_t taps = dev->fir_num_taps;
+	uint32_t i, n = 0;
+	uint8_t ch;
+
+	for (i = 0; i < nb_samples; i++) {
+		for (ch = 0; ch < ADAQ8092_DECIM_NUM_CH; ch++) {
+			dev->fir_hist[ch][dev->fir_pos] = in[ADAQ8092_DECIM_NUM_CH * i + ch];
+			dev->fir_hist[ch][dev->fir_pos + taps] =
+				in[ADAQ8092_DECIM_NUM_CH * i + ch];
+		}
+
+		if (++dev->fir_pos == taps)
+			dev->fir_pos = 0;
+
+		if (++dev->fir_phase < dev->fir_ratio)
+			continue;
+
+		dev->fir_phase = 0;
+		for (ch = 0; ch < ADAQ8092_DECIM_NUM_CH; ch++)
+			out[ADAQ8092_DECIM_NUM_CH * n + ch] =
+				adaq8092_decim_fir_dot(&dev->fir_hist[ch][dev->fir_pos],
+						       dev->fir_taps, taps);
+		n++;
+	}
+
+	return n;
+}
+
+/**
+ * @brief Clear the filter state.
+ * @param dev - The decimation structure.
+ */
+void adaq8092_decim_reset(struct adaq8092_decim_dev *dev)
+{
+	memset(dev->integ, 0, sizeof(dev->integ));
+	memset(dev->comb, 0, sizeof(dev->comb));
+	memset(dev->fir_hist, 0, sizeof(dev->fir_hist));
+	dev->cic_phase = 0;
+	dev->fir_phase = 0;
+	dev->fir_pos = 0;
+}
+
+/**
+ * @brief Initialize the decimation filter chain in caller provided storage.
+ * @param dev - The decimation structure, allocated by the caller.
+ * @param init_param - The structure that contains the initial parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_decim_init_static(struct adaq8092_decim_dev *dev,
+			       struct adaq8092_decim_init_param *init_param)
+{
+	int16_t taps[ADAQ8092_FIR_MAX_TAPS];
+	uint16_t num_taps, i;
+	uint64_t gain = 1;
+	int8_t growth = 0;
+	int ret;
+
+	if (!dev || init_param->cic_stages < 1 ||
+	    init_param->cic_stages > ADAQ8092_CIC_MAX_STAGES ||
+	    init_param->cic_ratio < 1 ||
+	    init_param->cic_ratio > ADAQ8092_CIC_MAX_RATIO ||
+	    init_param->fir_ratio > ADAQ8092_FIR_MAX_RATIO ||
+	    init_param->fir_num_taps > ADAQ8092_FIR_MAX_TAPS)
+		return -EINVAL;
+
+	/* The default length only applies to designed coefficients */
+	if (init_param->fir_ratio && init_param->fir_taps &&
+	    !init_param->fir_num_taps)
+		return -EINVAL;
+
+	memset(dev, 0, sizeof(*dev));
+
+	dev->input_rate = init_param->input_rate;
+	dev->cic_stages = init_param->cic_stages;
+	dev->cic_ratio = init_param->cic_ratio;
+	dev->fir_ratio = init_param->fir_ratio;
+
+	/*
+	 * CIC gain is ratio^stages. It is divided out exactly, whatever follows
+	 * the CIC, as a power of two shift and a multiplier in [1, 2).
+	 */
+	for (i = 0; i < dev->cic_stages; i++)
+		gain *= dev->cic_ratio;
+	while ((1ULL << growth) < gain)
+		growth++;
+	dev->cic_pre_shift = growth > ADAQ8092_CIC_NORM_BITS ?
+			     growth - ADAQ8092_CIC_NORM_BITS : 0;
+	dev->cic_shift = growth - dev->cic_pre_shift + ADAQ8092_CIC_NORM_BITS -
+			 ADAQ8092_DECIM_OUT_FRAC_BITS;
+	dev->cic_mult = (uint32_t)lround(ldexp(1.0, growth +
+					       ADAQ8092_CIC_NORM_BITS) / gain);
+
+	if (dev->fir_ratio) {
+		num_taps = init_param->fir_num_taps ? init_param->fir_num_taps :
+			   ADAQ8092_FIR_DEFAULT_TAPS;
+		if (init_param->fir_taps) {
+			memcpy(taps, init_param->fir_taps, num_taps * sizeof(*taps));
+		} else {
+			ret = adaq8092_decim_design_fir(taps, num_taps, dev->cic_stages,
+							dev->cic_ratio, dev->fir_ratio);
+			if (ret)
+				return ret;
+		}
+
+		/* Zero-pad at the oldest end so the kernel works in groups of four. */
+		dev->fir_num_taps = (num_taps + 3) & ~3;
+		if (dev->fir_num_taps > ADAQ8092_FIR_MAX_TAPS)
+			return -EINVAL;
+
+		for (i = 0; i < num_taps; i++)
+			dev->fir_taps[dev->fir_num_taps - 1 - i] = taps[i];
+	}
+
+	return 0;
+}
+
+#ifndef ADAQ8092_STATIC_ALLOC
+/**
+ * @brief Initialize the decimation filter chain.
+ * @param device - The decimation structure.
+ * @param init_param - The structure that contains the initial parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_decim_init(struct adaq8092_decim_dev **device,
+			struct adaq8092_decim_init_param *init_param)
+{
+	struct adaq8092_decim_dev *dev;
+	int ret;
+
+	dev = (struct adaq8092_decim_dev *)calloc(1, sizeof(*dev));
+	if (!dev)
+		return -ENOMEM;
+
+	ret = adaq8092_decim_init_static(dev, init_param);
+	if (ret) {
+		free(dev);
+		return ret;
+	}
+
+	*device = dev;
+
+	return 0;
+}
+
+/**
+ * @brief Remove the decimation filter chain.
+ * @param dev - The decimation structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_decim_remove(struct adaq8092_decim_dev *dev)
+{
+	if (!dev)
+		return -EINVAL;
+
+	free(dev);
+
+	return 0;
+}
+#endif
+
+/**
+ * @brief Get the total decimation ratio.
+ * @param dev - The decimation structure.
+ * @return The decimation ratio.
+ */
+uint32_t adaq8092_decim_get_ratio(struct adaq8092_decim_dev *dev)
+{
+	return dev->cic_ratio * (dev->fir_ratio ? dev->fir_ratio : 1);
+}
+
+/**
+ * @brief Get the output sampling frequency in Hz.
+ * @param dev - The decimation structure.
+ * @return The output sampling frequency.
+ */
+uint32_t adaq8092_decim_get_output_rate(struct adaq8092_decim_dev *dev)
+{
+	return dev->input_rate / adaq8092_decim_get_ratio(dev);
+}
+
+/**
+ * @brief Decimate a block of interleaved CH1/CH2 samples.
+ *
+ * The filter state is kept between calls, so consecutive blocks of a stream
+ * are processed without discontinuities. In-place operation is supported.
+ *
+ * @param dev - The decimation structure.
+ * @param in - Interleaved input samples.
+ * @param nb_samples - Number of input samples per channel.
+ * @param out - Interleaved output samples.
+ * @param nb_out - Number of output samples per channel.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_decim_process(struct adaq8092_decim_dev *dev, const int16_t *in,
+			   uint32_t nb_samples, int16_t *out,
+			   uint32_t *nb_out)
+{
+	uint32_t n;
+
+	if (!dev || !in || !out)
+		return -EINVAL;
+
+	n = adaq8092_decim_cic(dev, in, nb_samples, out);
+	if (dev->fir_ratio)
+		n = adaq8092_decim_fir(dev, out, n, out);
+
+	*nb_out = n;
+
+	return 0;
+}
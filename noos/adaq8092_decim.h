@@ -0,0 +1,151 @@
+/***************************************************************************//**
+ *   @file   adaq8092_decim.h
+ *   @brief  Header file of ADAQ8092 Decimation Filter Chain.
+ *   @author Antoniu Miclaus (antoniu.miclaus@analog.com)
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef __ADAQ8092_DECIM_H__
+#define __ADAQ8092_DECIM_H__
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define ADAQ8092_DECIM_NUM_CH		2
+/*
+ * The CIC registers are 64 bits wide and the output is exact as long as
+ * 14 + stages * log2(ratio) bits fit, so the input must be 14-bit codes:
+ * 5 stages at a ratio of 1024 use all 64 bits.
+ */
+#define ADAQ8092_CIC_MAX_STAGES		5
+#define ADAQ8092_CIC_MAX_RATIO		1024
+#define ADAQ8092_FIR_MAX_RATIO		8
+#define ADAQ8092_FIR_MAX_TAPS		64
+#define ADAQ8092_FIR_DEFAULT_TAPS	32
+
+/* Output samples carry two fractional bits more than the 14-bit input */
+#define ADAQ8092_DECIM_OUT_FRAC_BITS	2
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/**
+ * @struct adaq8092_decim_init_param
+ * @brief ADAQ8092 Decimation Filter Chain initialization structure.
+ */
+struct adaq8092_decim_init_param {
+	/** Input sampling frequency in Hz */
+	uint32_t	input_rate;
+	/** Number of CIC integrator/comb pairs */
+	uint8_t		cic_stages;
+	/** CIC decimation ratio, 1 bypasses the CIC */
+	uint16_t	cic_ratio;
+	/** FIR decimation ratio, 0 bypasses the FIR */
+	uint8_t		fir_ratio;
+	/** Q15 FIR coefficients with unity DC gain, NULL to design a CIC
+	 *  compensator */
+	const int16_t	*fir_taps;
+	/** Number of FIR coefficients, 0 selects the default length for
+	 *  designed coefficients and is rejected with custom ones */
+	uint16_t	fir_num_taps;
+};
+
+/**
+ * @struct adaq8092_decim_dev
+ * @brief ADAQ8092 Decimation Filter Chain structure.
+ */
+struct adaq8092_decim_dev {
+	uint32_t	input_rate;
+	uint8_t		cic_stages;
+	uint16_t	cic_ratio;
+	uint8_t		fir_ratio;
+	/** CIC gain normalization: ((x >> cic_pre_shift) * cic_mult) >> cic_shift */
+	uint8_t		cic_pre_shift;
+	uint8_t		cic_shift;
+	uint32_t	cic_mult;
+	uint16_t	cic_phase;
+	uint8_t		fir_phase;
+	/** Coefficient count, padded to a multiple of four */
+	uint16_t	fir_num_taps;
+	uint16_t	fir_pos;
+	uint64_t	integ[ADAQ8092_CIC_MAX_STAGES][ADAQ8092_DECIM_NUM_CH];
+	uint64_t	comb[ADAQ8092_CIC_MAX_STAGES][ADAQ8092_DECIM_NUM_CH];
+	/** Time-reversed coefficients */
+	int16_t		fir_taps[ADAQ8092_FIR_MAX_TAPS];
+	/** Mirrored delay lines, so a full window is always contiguous */
+	int16_t		fir_hist[ADAQ8092_DECIM_NUM_CH][2 * ADAQ8092_FIR_MAX_TAPS];
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Design a Q15 lowpass FIR compensating the CIC passband droop. */
+int adaq8092_decim_design_fir(int16_t *taps, uint16_t num_taps,
+			      uint8_t cic_stages, uint16_t cic_ratio,
+			      uint8_t fir_ratio);
+
+/* Initialize the decimation filter chain in caller provided storage. */
+int adaq8092_decim_init_static(struct adaq8092_decim_dev *dev,
+			       struct adaq8092_decim_init_param *init_param);
+
+#ifndef ADAQ8092_STATIC_ALLOC
+/* Initialize the decimation filter chain. */
+int adaq8092_decim_init(struct adaq8092_decim_dev **device,
+			struct adaq8092_decim_init_param *init_param);
+
+/* Remove the decimation filter chain. */
+int adaq8092_decim_remove(struct adaq8092_decim_dev *dev);
+#endif
+
+/* Clear the filter state. */
+void adaq8092_decim_reset(struct adaq8092_decim_dev *dev);
+
+/* Get the total decimation ratio. */
+uint32_t adaq8092_decim_get_ratio(struct adaq8092_decim_dev *dev);
+
+/* Get the output sampling frequency in Hz. */
+uint32_t adaq8092_decim_get_output_rate(struct adaq8092_decim_dev *dev);
+
+/* Decimate a block of interleaved CH1/CH2 samples. */
+int adaq8092_decim_process(struct adaq8092_decim_dev *dev, const int16_t *in,
+			   uint32_t nb_samples, int16_t *out,
+			   uint32_t *nb_out);
+
+#endif /* __ADAQ8092_DECIM_H__ */
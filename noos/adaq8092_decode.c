@@ -0,0 +1,123 @@
+/***************************************************************************//**
+ *   @file   adaq8092_decode.c
+ *   @brief  Implementation of ADAQ8092 Output Data Decoder.
+ *   @author Antoniu Miclaus (antoniu.miclaus@analog.com)
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include "adaq8092_decode.h"
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Decode a single raw ADAQ8092 output word.
+ *
+ * Only the low 14 bits are used, so words already sign extended by the AXI
+ * core are accepted. The alternate bit polarity is undone first since it is
+ * applied at the output buffers, after the randomizer.
+ *
+ * @param raw - The raw output word.
+ * @param flags - ADAQ8092_DECODE_* flags matching the device mode.
+ * @return The sample as 14-bit two's complement, sign extended to 16 bits.
+ */
+int16_t adaq8092_decode_sample(uint16_t raw, uint8_t flags)
+{
+	uint16_t val = raw & ADAQ8092_DECODE_DATA_MASK;
+
+	if (flags & ADAQ8092_DECODE_ABP)
+		val ^= ADAQ8092_DECODE_ABP_MASK;
+
+	if (flags & ADAQ8092_DECODE_RAND)
+		val ^= -(val & 1) & ADAQ8092_DECODE_RAND_MASK;
+
+	if (flags & ADAQ8092_DECODE_OFFSET_BINARY)
+		val ^= ADAQ8092_DECODE_SIGN;
+
+	return (int16_t)(val << 2) >> 2;
+}
+
+/**
+ * @brief Decode a block of raw ADAQ8092 output words.
+ * @param raw - The raw output words.
+ * @param data - The decoded samples, may alias raw.
+ * @param nb_samples - Number of words.
+ * @param flags - ADAQ8092_DECODE_* flags matching the device mode.
+ */
+void adaq8092_decode(const uint16_t *raw, int16_t *data, uint32_t nb_samples,
+		     uint8_t flags)
+{
+	uint16_t abp = flags & ADAQ8092_DECODE_ABP ? ADAQ8092_DECODE_ABP_MASK : 0;
+	uint16_t rand = flags & ADAQ8092_DECODE_RAND ? ADAQ8092_DECODE_RAND_MASK : 0;
+	uint16_t sign = flags & ADAQ8092_DECODE_OFFSET_BINARY ?
+			ADAQ8092_DECODE_SIGN : 0;
+	uint32_t i = 0;
+	uint16_t val;
+
+#ifdef __ARM_NEON
+	uint16x8_t v_mask = vdupq_n_u16(ADAQ8092_DECODE_DATA_MASK);
+	uint16x8_t v_abp = vdupq_n_u16(abp);
+	uint16x8_t v_rand = vdupq_n_u16(rand);
+	uint16x8_t v_sign = vdupq_n_u16(sign);
+	uint16x8_t v_one = vdupq_n_u16(1);
+	uint16x8_t v, lsb;
+
+	for (; i + 8 <= nb_samples; i += 8) {
+		v = veorq_u16(vandq_u16(vld1q_u16(&raw[i]), v_mask), v_abp);
+		/* 0 - lsb turns D0 into an all-ones or all-zeros lane mask. */
+		lsb = vsubq_u16(vdupq_n_u16(0), vandq_u16(v, v_one));
+		v = veorq_u16(v, vandq_u16(lsb, v_rand));
+		v = veorq_u16(v, v_sign);
+		vst1q_s16(&data[i], vshrq_n_s16(vreinterpretq_s16_u16(vshlq_n_u16(v, 2)),
+						2));
+	}
+#endif
+
+	/* Branch free, so the compiler can vectorize it where NEON is absent. */
+	for (; i < nb_samples; i++) {
+		val = (raw[i] & ADAQ8092_DECODE_DATA_MASK) ^ abp;
+		val ^= -(val & 1) & rand;
+		val ^= sign;
+		data[i] = (int16_t)(val << 2) >> 2;
+	}
+}
@@ -0,0 +1,73 @@
+/***************************************************************************//**
+ *   @file   adaq8092_decode.h
+ *   @brief  Header file of ADAQ8092 Output Data Decoder.
+ *   @author Antoniu Miclaus (antoniu.miclaus@analog.com)
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef __ADAQ8092_DECODE_H__
+#define __ADAQ8092_DECODE_H__
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* Decoder Mode Flags */
+#define ADAQ8092_DECODE_ABP		(1 << 0)
+#define ADAQ8092_DECODE_RAND		(1 << 1)
+#define ADAQ8092_DECODE_OFFSET_BINARY	(1 << 2)
+
+#define ADAQ8092_DECODE_DATA_MASK	0x3FFF
+/* Alternate bit polarity inverts D13, D11, ..., D1 */
+#define ADAQ8092_DECODE_ABP_MASK	0x2AAA
+/* The randomizer XORs D13..D1 with D0 */
+#define ADAQ8092_DECODE_RAND_MASK	0x3FFE
+#define ADAQ8092_DECODE_SIGN		0x2000
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Decode a single raw ADAQ8092 output word. */
+int16_t adaq8092_decode_sample(uint16_t raw, uint8_t flags);
+
+/* Decode a block of raw ADAQ8092 output words. */
+void adaq8092_decode(const uint16_t *raw, int16_t *data, uint32_t nb_samples,
+		     uint8_t flags);
+
+#endif /* __ADAQ8092_DECODE_H__ */
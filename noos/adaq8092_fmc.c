@@ -40,11 +40,13 @@
 /******************************************************************************/
 /***************************** Include Files **********************************/
 /******************************************************************************/
+#include <string.h>
 #include "xil_cache.h"
 #include "xparameters.h"
 #include "axi_adc_core.h"
 #include "axi_dmac.h"
 #include "adaq8092.h"
+#include "adaq8092_decode.h"
 #include "no-os/spi.h"
 #include "no-os/gpio.h"
 #include "spi_extra.h"
@@ -59,11 +61,231 @@
 #include "iio_axi_adc.h"
 #endif
 
+#ifdef TRIGGER_SUPPORT
+#include "adaq8092_trigger.h"
+#endif
+
+#ifdef DECIMATION_SUPPORT
+#include "adaq8092_decim.h"
+#endif
+
+#ifdef PACK_SUPPORT
+#include "adaq8092_pack.h"
+#endif
+
+#if defined(DMA_IRQ_SUPPORT) || defined(STREAM_SUPPORT) || defined(SYNC_SUPPORT)
+#include "no-os/irq.h"
+#include "irq_extra.h"
+#endif
+
+#ifdef DMA_IRQ_SUPPORT
+#include "xil_mmu.h"
+#include "xtime_l.h"
+#include "adaq8092_capture.h"
+#endif
+
+#ifdef SYNC_SUPPORT
+#include "adaq8092_capture.h"
+#include "adaq8092_sync.h"
+#endif
+
+#ifdef STREAM_SUPPORT
+#include "no-os/uart.h"
+#include "uart_extra.h"
+#include "adaq8092_stream.h"
+#endif
+
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
 /******************************************************************************/
 #define ADAQ8092_SAMPLES_PER_CH	1000
 #define ADAQ8092_NUM_CH		2
+#define ADAQ8092_CAPTURE_SAMPLES	(ADAQ8092_SAMPLES_PER_CH * ADAQ8092_NUM_CH)
+#define ADAQ8092_CAPTURE_BYTES	(ADAQ8092_CAPTURE_SAMPLES * sizeof(uint16_t))
+
+#ifdef TRIGGER_SUPPORT
+#define ADAQ8092_TRIG_BLOCK_SAMPLES	1024
+#define ADAQ8092_TRIG_NUM_BLOCKS	8
+#define ADAQ8092_TRIG_PRE_SAMPLES	256
+#define ADAQ8092_TRIG_POST_SAMPLES	768
+#define ADAQ8092_TRIG_MAX_BLOCKS	100000
+#define ADAQ8092_TRIG_NUM_EVENTS	10
+#define ADAQ8092_TRIG_RING_BYTES	(ADAQ8092_TRIG_BLOCK_SAMPLES * \
+					 ADAQ8092_TRIG_NUM_BLOCKS * \
+					 ADAQ8092_NUM_CH * sizeof(int16_t))
+#define ADAQ8092_TRIG_BUFFER_BYTES	((ADAQ8092_TRIG_PRE_SAMPLES + \
+					  ADAQ8092_TRIG_POST_SAMPLES) * \
+					 ADAQ8092_NUM_CH * sizeof(int16_t))
+
+static struct adaq8092_trig_dev trig_dev_storage;
+static struct adaq8092_thresh trig_thresh_storage;
+#endif
+
+#ifdef DECIMATION_SUPPORT
+#define ADAQ8092_SAMPLING_FREQ		105000000
+#define ADAQ8092_DECIM_CIC_STAGES	4
+#define ADAQ8092_DECIM_CIC_RATIO	25
+#define ADAQ8092_DECIM_FIR_RATIO	2
+
+static struct adaq8092_decim_dev decim_dev_storage;
+#endif
+
+#ifdef PACK_SUPPORT
+#define ADAQ8092_PACK_SAMPLES	ADAQ8092_CAPTURE_SAMPLES
+
+static uint8_t pack_buffer[ADAQ8092_PACK_HDR_SIZE +
+				  (ADAQ8092_PACK_SAMPLES / ADAQ8092_DELTA_BLOCK + 1) *
+				  ADAQ8092_DELTA_BLOCK_MAX_BYTES];
+static int16_t unpack_buffer[ADAQ8092_PACK_SAMPLES];
+#endif
+
+#ifdef DMA_IRQ_SUPPORT
+#define ADAQ8092_IRQ_NUM_BLOCKS	1000
+#define ADAQ8092_LONG_CAPTURE_BYTES	(8 * 1024 * 1024)
+#define ADAQ8092_LONG_SEGMENT_BYTES	(256 * 1024)
+/* Memory mode benchmark, MMU attributes are set per 1 MB section */
+#define ADAQ8092_MMU_SECTION_BYTES	(1024 * 1024)
+#define ADAQ8092_BENCH_BLOCK_BYTES	(64 * 1024)
+#define ADAQ8092_BENCH_PASSES		16
+
+static struct adaq8092_capture_dev capture_dev_storage;
+#endif
+
+#ifdef STREAM_SUPPORT
+static struct adaq8092_stream_dev stream_dev_storage;
+#endif
+
+#ifdef SYNC_SUPPORT
+#define ADAQ8092_SYNC_BOARDS		2
+#define ADAQ8092_SYNC_SAMPLES_PER_CH	8192
+#define ADAQ8092_SYNC_BYTES		(ADAQ8092_SYNC_SAMPLES_PER_CH * \
+					 ADAQ8092_NUM_CH * sizeof(int16_t))
+
+static struct adaq8092_dev sync_dev_storage;
+static struct adaq8092_capture_dev sync_capture_storage[ADAQ8092_SYNC_BOARDS];
+static struct adaq8092_sync_group sync_group_storage;
+#endif
+
+static struct adaq8092_dev adaq8092_dev_storage;
+
+/* Cache line aligned DMA arena, placed in DDR by the linker script. */
+static uint8_t dma_arena[ADAQ8092_DMA_ARENA_SIZE]
+__attribute__ ((section(ADAQ8092_DMA_ARENA_SECTION),
+		aligned(ADAQ8092_DMA_ARENA_ALIGN)));
+static uint32_t dma_arena_used;
+
+/***************************************************************************//**
+* @brief Carve a cache line aligned buffer from the DMA arena.
+* @param size - Buffer size in bytes.
+* @return The buffer, NULL if the arena is exhausted.
+*******************************************************************************/
+static void *dma_arena_alloc(uint32_t size)
+{
+	uint32_t offset = dma_arena_used;
+
+	size = (size + ADAQ8092_DMA_ARENA_ALIGN - 1) &
+	       ~(ADAQ8092_DMA_ARENA_ALIGN - 1);
+	if (size > ADAQ8092_DMA_ARENA_SIZE - offset)
+		return NULL;
+
+	dma_arena_used += size;
+
+	return &dma_arena[offset];
+}
+
+#ifdef STREAM_SUPPORT
+/***************************************************************************//**
+* @brief Binary stream transport over the UART.
+* @param ctx - The UART descriptor.
+* @param data - Frame to send.
+* @param bytes - Frame size.
+* @return 0 in case of success, negative error code otherwise.
+*******************************************************************************/
+static int adaq8092_stream_uart_write(void *ctx, const uint8_t *data,
+				      uint32_t bytes)
+{
+	int32_t ret;
+
+	ret = uart_write(ctx, data, bytes);
+
+	return ret < 0 ? ret : 0;
+}
+#endif
+
+#ifdef DMA_IRQ_SUPPORT
+/***************************************************************************//**
+* @brief Stream one MMU section in blocks and report the cost of a memory mode.
+* @param dev - The capture structure.
+* @param mode - The memory mode to benchmark.
+* @param name - Name printed in the report.
+* @param buffer - MMU section sized capture buffer.
+* @param decode_flags - Flags passed to adaq8092_decode().
+* @return 0 in case of success, negative error code otherwise.
+*******************************************************************************/
+static int adaq8092_mem_bench(struct adaq8092_capture_dev *dev,
+			      enum adaq8092_capture_mem_mode mode,
+			      const char *name, uint16_t *buffer,
+			      uint8_t decode_flags)
+{
+	const uint32_t block_samples = ADAQ8092_BENCH_BLOCK_BYTES / sizeof(*buffer);
+	const uint32_t nb_blocks = ADAQ8092_MMU_SECTION_BYTES /
+				   ADAQ8092_BENCH_BLOCK_BYTES * ADAQ8092_BENCH_PASSES;
+	uint32_t submitted = 0, first_seq = 0, seq, i;
+	XTime t_start, t_end, t0, t1, t_cpu = 0;
+	uint64_t elapsed_us, cpu_us;
+	uint16_t *block;
+	int ret;
+
+	ret = adaq8092_capture_set_mem_mode(dev, mode);
+	if (ret)
+		return ret;
+
+	XTime_GetTime(&t_start);
+	for (i = 0; i < nb_blocks; i++) {
+		/* Keep the DMAC queue full while the CPU works on block i. */
+		while (submitted < nb_blocks) {
+			block = &buffer[(submitted * block_samples) %
+					(ADAQ8092_MMU_SECTION_BYTES / sizeof(*buffer))];
+			ret = adaq8092_capture_submit(dev, (uintptr_t)block,
+						      ADAQ8092_BENCH_BLOCK_BYTES, &seq);
+			if (ret == -EBUSY)
+				break;
+			if (ret)
+				return ret;
+
+			if (!submitted)
+				first_seq = seq;
+			submitted++;
+		}
+
+		ret = adaq8092_capture_wait(dev, first_seq + i, 0);
+		if (ret)
+			return ret;
+
+		block = &buffer[(i * block_samples) %
+				(ADAQ8092_MMU_SECTION_BYTES / sizeof(*buffer))];
+
+		XTime_GetTime(&t0);
+		adaq8092_capture_sync(dev, (uintptr_t)block, ADAQ8092_BENCH_BLOCK_BYTES);
+		adaq8092_decode(block, (int16_t *)block, block_samples, decode_flags);
+		XTime_GetTime(&t1);
+		t_cpu += t1 - t0;
+	}
+	XTime_GetTime(&t_end);
+
+	elapsed_us = (t_end - t_start) / (COUNTS_PER_SECOND / 1000000);
+	cpu_us = t_cpu / (COUNTS_PER_SECOND / 1000000);
+
+	pr_info("%-10s %lu MB/s, CPU %lu us (%lu%%) for %lu MB\n", name,
+		(unsigned long)((uint64_t)nb_blocks * ADAQ8092_BENCH_BLOCK_BYTES /
+				(elapsed_us ? elapsed_us : 1)),
+		(unsigned long)cpu_us,
+		(unsigned long)(t_cpu * 100 / (t_end - t_start)),
+		(unsigned long)(nb_blocks * ADAQ8092_BENCH_BLOCK_BYTES >> 20));
+
+	return 0;
+}
+#endif
 
 /***************************************************************************//**
 * @brief main
@@ -71,8 +293,8 @@
 int main(void)
 {
 	int ret;
-	uint16_t adc_buffer[ADAQ8092_SAMPLES_PER_CH * ADAQ8092_NUM_CH]
-	__attribute__ ((aligned));
+	uint8_t decode_flags;
+	uint16_t *adc_buffer;
 
 	struct xil_spi_init_param xil_spi_init = {
 		.flags = 0,
@@ -153,16 +375,79 @@ int main(void)
 		.test_mode = ADAQ8092_TEST_CHECKERBOARD,
 		.alt_bit_pol_en = ADAQ8092_ALT_BIT_POL_OFF,
 		.data_rand_en = ADAQ8092_DATA_RAND_OFF,
-		.twos_comp = ADAQ8092_TWOS_COMPLEMENT
+		.twos_comp = ADAQ8092_TWOS_COMPLEMENT,
+		.spi_autotune_max_hz = ADAQ8092_SPI_MAX_SPEED_HZ
+	};
+	struct adaq8092_dev *adaq8092_device = &adaq8092_dev_storage;
+
+	adc_buffer = dma_arena_alloc(ADAQ8092_CAPTURE_BYTES);
+	if (!adc_buffer)
+		return -ENOMEM;
+
+#if defined(DMA_IRQ_SUPPORT) || defined(STREAM_SUPPORT) || defined(SYNC_SUPPORT)
+	struct xil_irq_init_param xil_irq_init_par = {
+		.type = IRQ_PS,
 	};
-	struct adaq8092_dev *adaq8092_device;
+	struct irq_init_param irq_init_param = {
+		.irq_ctrl_id = INTC_DEVICE_ID,
+		.platform_ops = &xil_irq_ops,
+		.extra = &xil_irq_init_par,
+	};
+	struct irq_ctrl_desc *irq_desc;
+
+	ret = irq_ctrl_init(&irq_desc, &irq_init_param);
+	if (ret)
+		return ret;
 
-	ret = adaq8092_init(&adaq8092_device, adaq8092_init_param);
+	ret = irq_global_enable(irq_desc);
+	if (ret)
+		return ret;
+#endif
+
+#ifdef STREAM_SUPPORT
+	/* The PS UART has no DMA, frames go out interrupt driven. */
+	struct xil_uart_init_param xil_uart_init_par = {
+		.type = UART_PS,
+		.irq_id = UART_IRQ_ID,
+		.irq_desc = irq_desc,
+	};
+	struct uart_init_param uart_init_param = {
+		.device_id = UART_DEVICE_ID,
+		.baud_rate = ADAQ8092_STREAM_BAUDRATE,
+		.size = UART_CS_8,
+		.parity = UART_PAR_NO,
+		.stop = UART_STOP_1_BIT,
+		.extra = &xil_uart_init_par,
+	};
+	struct uart_desc *uart_desc;
+	struct adaq8092_stream_dev *stream_dev = &stream_dev_storage;
+	struct adaq8092_stream_init_param stream_init_param = {
+		.ch_mask = BIT(ADAQ8092_NUM_CH) - 1,
+		.format = ADAQ8092_PACK_PACKED14,
+		.write = adaq8092_stream_uart_write,
+	};
+
+	ret = uart_init(&uart_desc, &uart_init_param);
+	if (ret)
+		return ret;
+
+	stream_init_param.ctx = uart_desc;
+	ret = adaq8092_stream_init_static(stream_dev, &stream_init_param);
+	if (ret)
+		return ret;
+#endif
+
+	ret = adaq8092_init_static(adaq8092_device, adaq8092_init_param);
 	if (ret) {
 		pr_err("ADAQ8092 device initialization failed!");
 		return ret;
 	}
 
+	pr_info("ADAQ8092 SPI clock: %lu Hz\n",
+		(unsigned long)adaq8092_device->spi_speed_hz);
+	pr_info("ADAQ8092 reset: %lu us\n",
+		(unsigned long)adaq8092_device->reset_us);
+
 	ret = axi_adc_init(&adaq8092_core,  &adaq8092_core_param);
 	if (ret) {
 		pr_err("axi_adc_init() error: %s\n", adaq8092_core->name);
@@ -178,14 +463,34 @@ int main(void)
 	pr_info("Start Caputre with Test pattern - Checkerboard \n");
 
 	ret = axi_dmac_transfer(adaq8092_dmac, (uintptr_t)adc_buffer,
-				sizeof(adc_buffer));
+				ADAQ8092_CAPTURE_BYTES);
 	if (ret) {
 		pr_err("axi_dmac_transfer() failed!\n");
 		return ret;
 	}
 
+	Xil_DCacheInvalidateRange((uintptr_t)adc_buffer, ADAQ8092_CAPTURE_BYTES);
+
+	/* Undo the randomizer/alternate bit polarity encoding in software. */
+	decode_flags = (adaq8092_get_alt_pol_en(adaq8092_device) ?
+			ADAQ8092_DECODE_ABP : 0) |
+		       (adaq8092_get_data_rand_en(adaq8092_device) ?
+			ADAQ8092_DECODE_RAND : 0) |
+		       (adaq8092_get_twos_comp(adaq8092_device) ?
+			0 : ADAQ8092_DECODE_OFFSET_BINARY);
+	adaq8092_decode(adc_buffer, (int16_t *)adc_buffer, ADAQ8092_CAPTURE_SAMPLES,
+			decode_flags);
+
+#ifdef STREAM_SUPPORT
+	ret = adaq8092_stream_write(stream_dev, (int16_t *)adc_buffer,
+				    ADAQ8092_CAPTURE_SAMPLES);
+	if (ret)
+		return ret;
+#else
 	for (int i = 0; i < ADAQ8092_SAMPLES_PER_CH; i+=2)
-		pr_info("CH1: %d CH2: %d \n",adc_buffer[i], adc_buffer[i+1]);
+		pr_info("CH1: %d CH2: %d \n", (int16_t)adc_buffer[i],
+			(int16_t)adc_buffer[i + 1]);
+#endif
 
 	ret = adaq8092_set_test_mode(adaq8092_device, ADAQ8092_TEST_OFF);
 	if (ret)
@@ -193,6 +498,431 @@ int main(void)
 
 	pr_info("\n Capture done.\n");
 
+#ifdef PACK_SUPPORT
+	struct adaq8092_pack_hdr pack_hdr = {
+		.format = ADAQ8092_PACK_DELTA,
+		.num_ch = ADAQ8092_NUM_CH,
+		.nb_samples = ADAQ8092_PACK_SAMPLES,
+	};
+
+	adaq8092_pack14((int16_t *)adc_buffer, pack_buffer, ADAQ8092_PACK_SAMPLES);
+	adaq8092_unpack14(pack_buffer, unpack_buffer, ADAQ8092_PACK_SAMPLES);
+	if (memcmp(unpack_buffer, adc_buffer, ADAQ8092_CAPTURE_BYTES))
+		pr_err("Packed 14-bit round trip mismatch!\n");
+
+	pr_info("Packed 14-bit: %lu -> %lu bytes\n", (unsigned long)ADAQ8092_CAPTURE_BYTES,
+		(unsigned long)adaq8092_pack14_size(ADAQ8092_PACK_SAMPLES));
+
+	pack_hdr.payload_bytes = adaq8092_delta_encode((int16_t *)adc_buffer,
+			       pack_buffer + ADAQ8092_PACK_HDR_SIZE,
+			       ADAQ8092_PACK_SAMPLES, ADAQ8092_NUM_CH);
+	adaq8092_pack_write_hdr(&pack_hdr, pack_buffer);
+
+	ret = adaq8092_delta_decode(pack_buffer + ADAQ8092_PACK_HDR_SIZE,
+				    pack_hdr.payload_bytes, unpack_buffer,
+				    ADAQ8092_PACK_SAMPLES, ADAQ8092_NUM_CH);
+	if (ret || memcmp(unpack_buffer, adc_buffer, ADAQ8092_CAPTURE_BYTES))
+		pr_err("Delta round trip mismatch!\n");
+
+	pr_info("Delta: %lu -> %lu bytes\n", (unsigned long)ADAQ8092_CAPTURE_BYTES,
+		(unsigned long)(ADAQ8092_PACK_HDR_SIZE + pack_hdr.payload_bytes));
+#endif
+
+#ifdef DMA_IRQ_SUPPORT
+	struct adaq8092_capture_dev *capture_dev = &capture_dev_storage;
+	struct adaq8092_capture_init_param capture_init_param = {
+		.dmac = adaq8092_dmac,
+		.irq_id = RX_DMA_IRQ_ID,
+		.mem_mode = ADAQ8092_CAPTURE_MEM_INVALIDATE,
+		.dcache_invalidate_range = (void (*)(uint32_t,
+						     uint32_t))Xil_DCacheInvalidateRange
+	};
+	uint16_t *irq_block[2] = {
+		adc_buffer,
+		dma_arena_alloc(ADAQ8092_CAPTURE_BYTES)
+	};
+	uint32_t irq_seq[2];
+	XTime t_start, t_end, t_wait, t_idle = 0;
+	int16_t irq_min = INT16_MAX, irq_max = INT16_MIN;
+
+	if (!irq_block[1])
+		return -ENOMEM;
+
+	capture_init_param.irq_ctrl = irq_desc;
+	ret = adaq8092_capture_init_static(capture_dev, &capture_init_param);
+	if (ret) {
+		pr_err("adaq8092_capture_init_static() failed!\n");
+		return ret;
+	}
+
+	pr_info("Start Interrupt Driven Capture - %d blocks \n",
+		ADAQ8092_IRQ_NUM_BLOCKS);
+
+	/*
+	 * Ping-pong: the next block is queued before waiting for the current
+	 * one, so the DMA fills one buffer while the CPU processes the other.
+	 */
+	XTime_GetTime(&t_start);
+	ret = adaq8092_capture_submit(capture_dev, (uintptr_t)irq_block[0],
+				      ADAQ8092_CAPTURE_BYTES, &irq_seq[0]);
+	if (ret)
+		return ret;
+
+	for (int i = 0; i < ADAQ8092_IRQ_NUM_BLOCKS; i++) {
+		uint16_t *block = irq_block[i % 2];
+
+		if (i + 1 < ADAQ8092_IRQ_NUM_BLOCKS) {
+			ret = adaq8092_capture_submit(capture_dev,
+						      (uintptr_t)irq_block[(i + 1) % 2],
+						      ADAQ8092_CAPTURE_BYTES,
+						      &irq_seq[(i + 1) % 2]);
+			if (ret)
+				return ret;
+		}
+
+		XTime_GetTime(&t_wait);
+		ret = adaq8092_capture_wait(capture_dev, irq_seq[i % 2], 0);
+		if (ret)
+			return ret;
+		XTime_GetTime(&t_end);
+		t_idle += t_end - t_wait;
+
+		adaq8092_capture_sync(capture_dev, (uintptr_t)block,
+				      ADAQ8092_CAPTURE_BYTES);
+		adaq8092_decode(block, (int16_t *)block, ADAQ8092_CAPTURE_SAMPLES,
+				decode_flags);
+
+		for (int j = 0; j < ADAQ8092_CAPTURE_SAMPLES; j++) {
+			if ((int16_t)block[j] < irq_min)
+				irq_min = block[j];
+			if ((int16_t)block[j] > irq_max)
+				irq_max = block[j];
+		}
+	}
+	XTime_GetTime(&t_end);
+
+	pr_info("Captured %d blocks in %lu us, min: %d max: %d, CPU idle: %lu%%\n",
+		ADAQ8092_IRQ_NUM_BLOCKS,
+		(unsigned long)((t_end - t_start) / (COUNTS_PER_SECOND / 1000000)),
+		irq_min, irq_max,
+		(unsigned long)(t_idle * 100 / (t_end - t_start)));
+
+	/* Long capture, chained in segments and checked for dropped samples. */
+	uint16_t *long_buffer = dma_arena_alloc(ADAQ8092_LONG_CAPTURE_BYTES);
+	int64_t gap;
+
+	if (!long_buffer)
+		return -ENOMEM;
+
+	ret = adaq8092_set_test_mode(adaq8092_device, ADAQ8092_TEST_ALTERNATING);
+	if (ret)
+		return ret;
+
+	ret = adaq8092_capture_chunked(capture_dev, (uintptr_t)long_buffer,
+				       ADAQ8092_LONG_CAPTURE_BYTES,
+				       ADAQ8092_LONG_SEGMENT_BYTES);
+	if (ret)
+		return ret;
+
+	adaq8092_capture_sync(capture_dev, (uintptr_t)long_buffer,
+			      ADAQ8092_LONG_CAPTURE_BYTES);
+
+	gap = adaq8092_capture_check_alternating(long_buffer,
+			ADAQ8092_LONG_CAPTURE_BYTES / sizeof(*long_buffer),
+			ADAQ8092_NUM_CH);
+	if (gap >= 0)
+		pr_err("Chunked capture discontinuity at sample %lu!\n",
+		       (unsigned long)gap);
+	else
+		pr_info("Chunked capture of %d bytes in %d byte segments is continuous\n",
+			ADAQ8092_LONG_CAPTURE_BYTES, ADAQ8092_LONG_SEGMENT_BYTES);
+
+	ret = adaq8092_set_test_mode(adaq8092_device, ADAQ8092_TEST_OFF);
+	if (ret)
+		return ret;
+
+	/*
+	 * Memory mode benchmark on two 1 MB sections carved from the arena: one
+	 * stays cacheable, the other is remapped non-cacheable for the test.
+	 */
+	uint8_t *bench_arena = dma_arena_alloc(3 * ADAQ8092_MMU_SECTION_BYTES);
+	uint16_t *bench_cached, *bench_uncached;
+
+	if (!bench_arena)
+		return -ENOMEM;
+
+	bench_cached = (uint16_t *)(((uintptr_t)bench_arena +
+				     ADAQ8092_MMU_SECTION_BYTES - 1) &
+				    ~(uintptr_t)(ADAQ8092_MMU_SECTION_BYTES - 1));
+	bench_uncached = bench_cached + ADAQ8092_MMU_SECTION_BYTES /
+			 sizeof(*bench_cached);
+
+	Xil_DCacheFlushRange((uintptr_t)bench_uncached, ADAQ8092_MMU_SECTION_BYTES);
+	Xil_SetTlbAttributes((UINTPTR)bench_uncached, NORM_NONCACHE);
+
+	pr_info("Capture memory mode benchmark\n");
+
+	ret = adaq8092_mem_bench(capture_dev, ADAQ8092_CAPTURE_MEM_INVALIDATE,
+				 "invalidate", bench_cached, decode_flags);
+	if (ret)
+		return ret;
+
+	ret = adaq8092_mem_bench(capture_dev, ADAQ8092_CAPTURE_MEM_UNCACHED,
+				 "uncached", bench_uncached, decode_flags);
+	if (ret)
+		return ret;
+
+	/* Only valid when the HDL routes the DMAC through the ACP. */
+	if (ADAQ8092_DMA_ACP) {
+		ret = adaq8092_mem_bench(capture_dev, ADAQ8092_CAPTURE_MEM_COHERENT,
+					 "acp", bench_cached, decode_flags);
+		if (ret)
+			return ret;
+	}
+
+	Xil_SetTlbAttributes((UINTPTR)bench_uncached, NORM_WB_CACHE);
+
+	ret = adaq8092_capture_set_mem_mode(capture_dev,
+					    ADAQ8092_CAPTURE_MEM_INVALIDATE);
+	if (ret)
+		return ret;
+
+	adaq8092_capture_remove_static(capture_dev);
+#endif
+
+#ifdef SYNC_SUPPORT
+	/* Second FMC: same wiring, own chip select, GPIOs, ADC core and DMAC. */
+	struct spi_init_param sync_spi_param = adaq8092_spi_param;
+	struct gpio_init_param sync_par_ser_param = gpio_par_ser_init_param;
+	struct gpio_init_param sync_pd1_param = gpio_adc_pd1_param;
+	struct gpio_init_param sync_pd2_param = gpio_adc_pd2_param;
+	struct gpio_init_param sync_1v8_param = gpio_en_1v8_param;
+	struct adaq8092_init_param sync_init_param = adaq8092_init_param;
+	struct axi_adc_init sync_core_param = adaq8092_core_param;
+	struct axi_dmac_init sync_dmac_param = adaq8092_dmac_param;
+	struct axi_adc *sync_core;
+	struct axi_dmac *sync_dmac;
+	struct adaq8092_capture_init_param sync_capture_param = {
+		.mem_mode = ADAQ8092_CAPTURE_MEM_INVALIDATE,
+		.dcache_invalidate_range = (void (*)(uint32_t,
+						     uint32_t))Xil_DCacheInvalidateRange
+	};
+	struct adaq8092_sync_init_param sync_group_param = {
+		.nb_members = ADAQ8092_SYNC_BOARDS,
+		.ref_ch = 0,
+		.threshold = 0,
+	};
+	struct adaq8092_sync_group *sync_group = &sync_group_storage;
+	uintptr_t sync_buffer[ADAQ8092_SYNC_BOARDS];
+	const int16_t *sync_data[ADAQ8092_SYNC_BOARDS];
+	int16_t *sync_merged;
+	uint32_t sync_samples;
+
+	sync_spi_param.chip_select = SPI_CS_1;
+	sync_par_ser_param.number = GPIO_PAR_SER_NR_1;
+	sync_pd1_param.number = GPIO_PD1_NR_1;
+	sync_pd2_param.number = GPIO_PD2_NR_1;
+	sync_1v8_param.number = GPIO_1V8_NR_1;
+	sync_init_param.spi_init = &sync_spi_param;
+	sync_init_param.gpio_par_ser_param = &sync_par_ser_param;
+	sync_init_param.gpio_adc_pd1_param = &sync_pd1_param;
+	sync_init_param.gpio_adc_pd2_param = &sync_pd2_param;
+	sync_init_param.gpio_en_1p8_param = &sync_1v8_param;
+	sync_init_param.test_mode = ADAQ8092_TEST_OFF;
+	sync_core_param.name = "adaq8092_core_1";
+	sync_core_param.base = RX_CORE_BASEADDR_1;
+	sync_dmac_param.name = "adaq8092_dmac_1";
+	sync_dmac_param.base = RX_DMA_BASEADDR_1;
+
+	ret = adaq8092_init_static(&sync_dev_storage, sync_init_param);
+	if (ret)
+		return ret;
+
+	ret = axi_adc_init(&sync_core, &sync_core_param);
+	if (ret)
+		return ret;
+
+	ret = axi_dmac_init(&sync_dmac, &sync_dmac_param);
+	if (ret)
+		return ret;
+
+	sync_capture_param.irq_ctrl = irq_desc;
+	for (int i = 0; i < ADAQ8092_SYNC_BOARDS; i++) {
+		sync_capture_param.dmac = i ? sync_dmac : adaq8092_dmac;
+		sync_capture_param.irq_id = i ? RX_DMA_IRQ_ID_1 : RX_DMA_IRQ_ID;
+		ret = adaq8092_capture_init_static(&sync_capture_storage[i],
+						   &sync_capture_param);
+		if (ret)
+			return ret;
+
+		sync_group_param.member[i].capture = &sync_capture_storage[i];
+		sync_group_param.member[i].adc = i ? sync_core : adaq8092_core;
+
+		sync_buffer[i] = (uintptr_t)dma_arena_alloc(ADAQ8092_SYNC_BYTES);
+		if (!sync_buffer[i])
+			return -ENOMEM;
+		sync_data[i] = (const int16_t *)sync_buffer[i];
+	}
+
+	sync_merged = dma_arena_alloc(ADAQ8092_SYNC_BOARDS * ADAQ8092_SYNC_BYTES);
+	if (!sync_merged)
+		return -ENOMEM;
+
+	ret = adaq8092_sync_init_static(sync_group, &sync_group_param);
+	if (ret)
+		return ret;
+
+	/*
+	 * CH1 of every board is fed the same signal, its first rising zero
+	 * crossing aligns the boards.
+	 */
+	pr_info("Start Synchronized Capture - %d boards \n", ADAQ8092_SYNC_BOARDS);
+
+	ret = adaq8092_sync_start(sync_group, sync_buffer, ADAQ8092_SYNC_BYTES);
+	if (ret)
+		return ret;
+
+	ret = adaq8092_sync_wait(sync_group, 0);
+	if (ret)
+		return ret;
+
+	for (int i = 0; i < ADAQ8092_SYNC_BOARDS; i++) {
+		adaq8092_capture_sync(&sync_capture_storage[i], sync_buffer[i],
+				      ADAQ8092_SYNC_BYTES);
+		adaq8092_decode((uint16_t *)sync_buffer[i], (int16_t *)sync_buffer[i],
+				ADAQ8092_SYNC_SAMPLES_PER_CH * ADAQ8092_NUM_CH,
+				decode_flags);
+	}
+
+	ret = adaq8092_sync_align(sync_group, sync_data,
+				  ADAQ8092_SYNC_SAMPLES_PER_CH);
+	if (ret) {
+		pr_err("No alignment edge on the reference channel!\n");
+		return ret;
+	}
+
+	sync_samples = adaq8092_sync_merge(sync_group, sync_data,
+					   ADAQ8092_SYNC_SAMPLES_PER_CH,
+					   sync_merged);
+
+	for (int i = 0; i < ADAQ8092_SYNC_BOARDS; i++)
+		pr_info("Board %d offset: %ld samples\n", i,
+			(long)sync_group->offset[i]);
+	pr_info("Merged %lu samples x %d channels\n", (unsigned long)sync_samples,
+		ADAQ8092_SYNC_BOARDS * ADAQ8092_NUM_CH);
+
+	for (int i = 0; i < ADAQ8092_SYNC_BOARDS; i++)
+		adaq8092_capture_remove_static(&sync_capture_storage[i]);
+#endif
+
+#ifdef TRIGGER_SUPPORT
+	struct adaq8092_trig_init_param trig_init_param = {
+		.dmac = adaq8092_dmac,
+		.ring = dma_arena_alloc(ADAQ8092_TRIG_RING_BYTES),
+		.block_samples = ADAQ8092_TRIG_BLOCK_SAMPLES,
+		.num_blocks = ADAQ8092_TRIG_NUM_BLOCKS,
+		.pre_samples = ADAQ8092_TRIG_PRE_SAMPLES,
+		.post_samples = ADAQ8092_TRIG_POST_SAMPLES,
+		.thresh = &trig_thresh_storage,
+		.cond = {
+			.channel = 0,
+			.type = ADAQ8092_TRIG_EDGE,
+			.polarity = ADAQ8092_TRIG_RISING,
+			.level = 0,
+		},
+		.dcache_invalidate_range = (void (*)(uint32_t,
+						     uint32_t))Xil_DCacheInvalidateRange
+	};
+	struct adaq8092_trig_dev *trig_dev = &trig_dev_storage;
+	int16_t *trig_buffer = dma_arena_alloc(ADAQ8092_TRIG_BUFFER_BYTES);
+	uint64_t trig_pos;
+
+	if (!trig_init_param.ring || !trig_buffer)
+		return -ENOMEM;
+
+	/* Report input saturation of both channels alongside the triggers */
+	adaq8092_thresh_init(&trig_thresh_storage);
+
+	ret = adaq8092_trig_init_static(trig_dev, &trig_init_param);
+	if (ret) {
+		pr_err("adaq8092_trig_init_static() failed!\n");
+		return ret;
+	}
+
+	pr_info("Start Triggered Capture - CH1 rising edge through 0 \n");
+
+	for (int i = 0; i < ADAQ8092_TRIG_NUM_EVENTS; i++) {
+		ret = adaq8092_trig_capture(trig_dev, trig_buffer,
+					    ADAQ8092_TRIG_MAX_BLOCKS, &trig_pos);
+		if (ret) {
+			pr_err("adaq8092_trig_capture() failed!\n");
+			break;
+		}
+
+		pr_info("Trigger %d at sample %lu, missed: %lu, rearm latency: %lu samples\n",
+			i, (unsigned long)trig_pos, (unsigned long)trig_dev->missed_count,
+			(unsigned long)trig_dev->rearm_latency);
+	}
+
+	for (int i = 0; i < ADAQ8092_NUM_CH; i++)
+		pr_info("CH%d over-range: %lu, last at sample %lu\n", i + 1,
+			(unsigned long)trig_thresh_storage.count[i],
+			(unsigned long)trig_thresh_storage.last_pos[i]);
+#endif
+
+#ifdef DECIMATION_SUPPORT
+	struct adaq8092_decim_init_param decim_init_param = {
+		.input_rate = ADAQ8092_SAMPLING_FREQ,
+		.cic_stages = ADAQ8092_DECIM_CIC_STAGES,
+		.cic_ratio = ADAQ8092_DECIM_CIC_RATIO,
+		.fir_ratio = ADAQ8092_DECIM_FIR_RATIO,
+	};
+	struct adaq8092_decim_dev *decim_dev = &decim_dev_storage;
+	uint32_t decim_samples;
+
+	ret = adaq8092_decim_init_static(decim_dev, &decim_init_param);
+	if (ret) {
+		pr_err("adaq8092_decim_init_static() failed!\n");
+		return ret;
+	}
+
+	ret = axi_dmac_transfer(adaq8092_dmac, (uintptr_t)adc_buffer,
+				ADAQ8092_CAPTURE_BYTES);
+	if (ret) {
+		pr_err("axi_dmac_transfer() failed!\n");
+		return ret;
+	}
+
+	Xil_DCacheInvalidateRange((uintptr_t)adc_buffer, ADAQ8092_CAPTURE_BYTES);
+
+	adaq8092_decode(adc_buffer, (int16_t *)adc_buffer, ADAQ8092_CAPTURE_SAMPLES,
+			decode_flags);
+
+	ret = adaq8092_decim_process(decim_dev, (int16_t *)adc_buffer,
+				     ADAQ8092_SAMPLES_PER_CH, (int16_t *)adc_buffer,
+				     &decim_samples);
+	if (ret)
+		return ret;
+
+	pr_info("Decimated by %lu: %lu samples per channel at %lu Hz\n",
+		(unsigned long)adaq8092_decim_get_ratio(decim_dev),
+		(unsigned long)decim_samples,
+		(unsigned long)adaq8092_decim_get_output_rate(decim_dev));
+
+#ifdef STREAM_SUPPORT
+	/* Decimated samples carry extra fraction bits, send them unpacked. */
+	stream_dev->format = ADAQ8092_PACK_RAW16;
+	ret = adaq8092_stream_write(stream_dev, (int16_t *)adc_buffer,
+				    decim_samples * ADAQ8092_NUM_CH);
+	if (ret)
+		return ret;
+#else
+	for (uint32_t i = 0; i < decim_samples; i++)
+		pr_info("CH1: %d CH2: %d \n", (int16_t)adc_buffer[2 * i],
+			(int16_t)adc_buffer[2 * i + 1]);
+#endif
+#endif
+
 #ifdef IIO_SUPPORT
 	struct iio_axi_adc_desc *iio_axi_adc_desc;
 	struct iio_device *dev_desc;
@@ -204,9 +934,22 @@ int main(void)
 						     uint32_t))Xil_DCacheInvalidateRange
 	};
 
+#ifdef SYNC_SUPPORT
+	/*
+	 * Each board is a separate IIO device with half of the arena. The
+	 * adaq8092_sync_merge() output above is not exposed through IIO: the
+	 * alignment can fail or trim a refill, which the fixed size IIO buffer
+	 * cannot express. pyadi's adaq8092_sync aligns and merges the devices.
+	 */
+#define ADAQ8092_IIO_BUFF_SIZE	(ADAQ8092_DMA_ARENA_SIZE / 2)
+#else
+#define ADAQ8092_IIO_BUFF_SIZE	ADAQ8092_DMA_ARENA_SIZE
+#endif
+	/* The standalone captures are done, hand the whole arena to IIO. */
+	dma_arena_used = 0;
 	struct iio_data_buffer read_buff = {
-		.buff = (void *)adc_buffer,
-		.size = 0xFFFFFFFF,
+		.buff = dma_arena_alloc(ADAQ8092_IIO_BUFF_SIZE),
+		.size = ADAQ8092_IIO_BUFF_SIZE,
 	};
 
 	ret = iio_axi_adc_init(&iio_axi_adc_desc, &iio_axi_adc_init_par);
@@ -214,9 +957,29 @@ int main(void)
 		return ret;
 	iio_axi_adc_get_dev_descriptor(iio_axi_adc_desc, &dev_desc);
 
+#ifdef SYNC_SUPPORT
+	struct iio_axi_adc_desc *iio_sync_desc;
+	struct iio_device *sync_dev_desc;
+	struct iio_data_buffer sync_read_buff = {
+		.buff = dma_arena_alloc(ADAQ8092_IIO_BUFF_SIZE),
+		.size = ADAQ8092_IIO_BUFF_SIZE,
+	};
+
+	iio_axi_adc_init_par.rx_adc = sync_core;
+	iio_axi_adc_init_par.rx_dmac = sync_dmac;
+	ret = iio_axi_adc_init(&iio_sync_desc, &iio_axi_adc_init_par);
+	if (ret < 0)
+		return ret;
+	iio_axi_adc_get_dev_descriptor(iio_sync_desc, &sync_dev_desc);
+#endif
+
 	struct iio_app_device devices[] = {
 		IIO_APP_DEVICE("adaq8092_dev", iio_axi_adc_desc, dev_desc,
 			       &read_buff, NULL),
+#ifdef SYNC_SUPPORT
+		IIO_APP_DEVICE("adaq8092_dev_1", iio_sync_desc, sync_dev_desc,
+			       &sync_read_buff, NULL),
+#endif
 	};
 
 	return iio_app_run(devices, ARRAY_SIZE(devices));
@@ -0,0 +1,373 @@
+/***************************************************************************//**
+ *   @file   adaq8092_pack.c
+ *   @brief  Implementation of ADAQ8092 Sample Packing and Compression.
+ *   @author Antoniu Miclaus (antoniu.miclaus@analog.com)
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <errno.h>
+#include "adaq8092_pack.h"
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define ADAQ8092_PACK_MASK	0x3FFF
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Get the packed size of a block of samples.
+ * @param nb_samples - Number of samples.
+ * @return Number of bytes, the last group is zero padded.
+ */
+uint32_t adaq8092_pack14_size(uint32_t nb_samples)
+{
+	return (nb_samples + ADAQ8092_PACK14_GROUP - 1) / ADAQ8092_PACK14_GROUP *
+	       ADAQ8092_PACK14_GROUP_BYTES;
+}
+
+/**
+ * @brief Pack one group of four samples.
+ * @param data - The samples.
+ * @param buff - The seven byte destination.
+ * @param count - Number of valid samples in the group.
+ */
+static void adaq8092_pack14_group(const int16_t *data, uint8_t *buff,
+				  uint32_t count)
+{
+	uint64_t word = 0;
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		word |= (uint64_t)(data[i] & ADAQ8092_PACK_MASK) << (14 * i);
+
+	for (i = 0; i < ADAQ8092_PACK14_GROUP_BYTES; i++)
+		buff[i] = word >> (8 * i);
+}
+
+/**
+ * @brief Pack 14-bit samples, four samples into seven bytes.
+ * @param data - The samples, the upper two bits are ignored.
+ * @param buff - Destination of adaq8092_pack14_size() bytes.
+ * @param nb_samples - Number of samples.
+ */
+void adaq8092_pack14(const int16_t *data, uint8_t *buff, uint32_t nb_samples)
+{
+	uint32_t i = 0;
+
+#ifdef __ARM_NEON
+	uint16x4_t mask = vdup_n_u16(ADAQ8092_PACK_MASK);
+	uint16x4x4_t s;
+	uint32x4_t lo, hi;
+	uint64x2_t w01, w23;
+
+	/*
+	 * Sixteen samples per step, one group per lane. Each 56-bit word is
+	 * stored with an 8-byte write whose extra byte is overwritten by the
+	 * next group, so one group is always left for the scalar tail.
+	 */
+	for (; i + 20 <= nb_samples; i += 16) {
+		s = vld4_u16((const uint16_t *)&data[i]);
+		lo = vorrq_u32(vmovl_u16(vand_u16(s.val[0], mask)),
+			       vshlq_n_u32(vmovl_u16(vand_u16(s.val[1], mask)), 14));
+		hi = vorrq_u32(vmovl_u16(vand_u16(s.val[2], mask)),
+			       vshlq_n_u32(vmovl_u16(vand_u16(s.val[3], mask)), 14));
+		w01 = vorrq_u64(vmovl_u32(vget_low_u32(lo)),
+				vshlq_n_u64(vmovl_u32(vget_low_u32(hi)), 28));
+		w23 = vorrq_u64(vmovl_u32(vget_high_u32(lo)),
+				vshlq_n_u64(vmovl_u32(vget_high_u32(hi)), 28));
+
+		vst1_u8(buff, vreinterpret_u8_u64(vget_low_u64(w01)));
+		vst1_u8(buff + 7, vreinterpret_u8_u64(vget_high_u64(w01)));
+		vst1_u8(buff + 14, vreinterpret_u8_u64(vget_low_u64(w23)));
+		vst1_u8(buff + 21, vreinterpret_u8_u64(vget_high_u64(w23)));
+		buff += 4 * ADAQ8092_PACK14_GROUP_BYTES;
+	}
+#endif
+
+	for (; i < nb_samples; i += ADAQ8092_PACK14_GROUP) {
+		adaq8092_pack14_group(&data[i], buff,
+				      nb_samples - i < ADAQ8092_PACK14_GROUP ?
+				      nb_samples - i : ADAQ8092_PACK14_GROUP);
+		buff += ADAQ8092_PACK14_GROUP_BYTES;
+	}
+}
+
+#ifdef __ARM_NEON
+/**
+ * @brief Extract one sign extended sample from four packed groups.
+ * @param w01 - Groups 0 and 1.
+ * @param w23 - Groups 2 and 3.
+ * @param shift - Bit position of the sample in the group.
+ * @return The sample of each group.
+ */
+static inline int16x4_t adaq8092_unpack14_field(uint64x2_t w01, uint64x2_t w23,
+						 int64_t shift)
+{
+	uint64x2_t mask = vdupq_n_u64(ADAQ8092_PACK_MASK);
+	int64x2_t sh = vdupq_n_s64(-shift);
+	uint32x4_t v;
+
+	v = vcombine_u32(vmovn_u64(vandq_u64(vshlq_u64(w01, sh), mask)),
+			 vmovn_u64(vandq_u64(vshlq_u64(w23, sh), mask)));
+
+	return vshr_n_s16(vshl_n_s16(vreinterpret_s16_u16(vmovn_u32(v)), 2), 2);
+}
+#endif
+
+/**
+ * @brief Unpack 14-bit samples, sign extending them to 16 bits.
+ * @param buff - Packed data of adaq8092_pack14_size() bytes.
+ * @param data - The samples.
+ * @param nb_samples - Number of samples.
+ */
+void adaq8092_unpack14(const uint8_t *buff, int16_t *data,
+		       uint32_t nb_samples)
+{
+	uint64_t word;
+	uint32_t i = 0, j;
+
+#ifdef __ARM_NEON
+	uint64x2_t w01, w23;
+	int16x4x4_t s;
+
+	/* 8-byte loads read one byte past each group, see adaq8092_pack14(). */
+	for (; i + 20 <= nb_samples; i += 16) {
+		w01 = vcombine_u64(vreinterpret_u64_u8(vld1_u8(buff)),
+				   vreinterpret_u64_u8(vld1_u8(buff + 7)));
+		w23 = vcombine_u64(vreinterpret_u64_u8(vld1_u8(buff + 14)),
+				   vreinterpret_u64_u8(vld1_u8(buff + 21)));
+
+		s.val[0] = adaq8092_unpack14_field(w01, w23, 0);
+		s.val[1] = adaq8092_unpack14_field(w01, w23, 14);
+		s.val[2] = adaq8092_unpack14_field(w01, w23, 28);
+		s.val[3] = adaq8092_unpack14_field(w01, w23, 42);
+
+		vst4_s16(&data[i], s);
+		buff += 4 * ADAQ8092_PACK14_GROUP_BYTES;
+	}
+#endif
+
+	for (; i < nb_samples; i += ADAQ8092_PACK14_GROUP) {
+		word = 0;
+		for (j = 0; j < ADAQ8092_PACK14_GROUP_BYTES; j++)
+			word |= (uint64_t)buff[j] << (8 * j);
+
+		for (j = 0; j < ADAQ8092_PACK14_GROUP && i + j < nb_samples; j++)
+			data[i + j] = (int16_t)((word >> (14 * j)) << 2) >> 2;
+
+		buff += ADAQ8092_PACK14_GROUP_BYTES;
+	}
+}
+
+/**
+ * @brief Get the worst case delta encoded size of a block of samples.
+ * @param nb_samples - Number of samples.
+ * @return Number of bytes.
+ */
+uint32_t adaq8092_delta_max_size(uint32_t nb_samples)
+{
+	return (nb_samples + ADAQ8092_DELTA_BLOCK - 1) / ADAQ8092_DELTA_BLOCK *
+	       ADAQ8092_DELTA_BLOCK_MAX_BYTES;
+}
+
+/**
+ * @brief Delta encode interleaved 14-bit samples.
+ *
+ * Each sample is replaced by its 14-bit wrapped difference to the previous
+ * sample of the same channel, zigzag mapped. Blocks of 64 values are then
+ * bit packed at the width of the largest value in the block, LSB first.
+ *
+ * @param data - Interleaved samples.
+ * @param buff - Destination of adaq8092_delta_max_size() bytes.
+ * @param nb_samples - Total number of samples.
+ * @param num_ch - Number of interleaved channels.
+ * @return Number of bytes written.
+ */
+uint32_t adaq8092_delta_encode(const int16_t *data, uint8_t *buff,
+			       uint32_t nb_samples, uint8_t num_ch)
+{
+	uint16_t zz[ADAQ8092_DELTA_BLOCK], max;
+	uint32_t i, j, k, pos = 0;
+	uint8_t width, nbits;
+	uint64_t bits;
+	int16_t delta;
+
+	for (i = 0; i < nb_samples; i += ADAQ8092_DELTA_BLOCK) {
+		max = 0;
+		for (j = 0; j < ADAQ8092_DELTA_BLOCK; j++) {
+			k = i + j;
+			if (k >= nb_samples) {
+				zz[j] = 0;
+				continue;
+			}
+
+			delta = (data[k] - (k >= num_ch ? data[k - num_ch] : 0)) &
+				ADAQ8092_PACK_MASK;
+			delta = (int16_t)(delta << 2) >> 2;
+			zz[j] = ((delta * 2) ^ (delta < 0 ? -1 : 0)) & ADAQ8092_PACK_MASK;
+			max |= zz[j];
+		}
+
+		for (width = 0; max; max >>= 1)
+			width++;
+
+		buff[pos++] = width;
+		bits = 0;
+		nbits = 0;
+		for (j = 0; j < ADAQ8092_DELTA_BLOCK; j++) {
+			bits |= (uint64_t)zz[j] << nbits;
+			nbits += width;
+			while (nbits >= 8) {
+				buff[pos++] = bits;
+				bits >>= 8;
+				nbits -= 8;
+			}
+		}
+	}
+
+	return pos;
+}
+
+/**
+ * @brief Decode delta encoded samples.
+ * @param buff - Encoded data.
+ * @param nb_bytes - Number of encoded bytes.
+ * @param data - Interleaved samples.
+ * @param nb_samples - Total number of samples.
+ * @param num_ch - Number of interleaved channels.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_delta_decode(const uint8_t *buff, uint32_t nb_bytes,
+			  int16_t *data, uint32_t nb_samples, uint8_t num_ch)
+{
+	uint32_t i, j, k, pos = 0, next;
+	uint8_t width, nbits;
+	uint64_t bits;
+	uint16_t zz;
+	int16_t delta;
+
+	for (i = 0; i < nb_samples; i += ADAQ8092_DELTA_BLOCK) {
+		if (pos >= nb_bytes)
+			return -EINVAL;
+
+		width = buff[pos++];
+		next = pos + ADAQ8092_DELTA_BLOCK * width / 8;
+		if (width > ADAQ8092_DELTA_MAX_WIDTH || next > nb_bytes)
+			return -EINVAL;
+
+		bits = 0;
+		nbits = 0;
+		for (j = 0; j < ADAQ8092_DELTA_BLOCK && i + j < nb_samples; j++) {
+			while (nbits < width) {
+				bits |= (uint64_t)buff[pos++] << nbits;
+				nbits += 8;
+			}
+
+			zz = bits & ((1U << width) - 1);
+			bits >>= width;
+			nbits -= width;
+
+			k = i + j;
+			delta = (zz >> 1) ^ -(zz & 1);
+			data[k] = (int16_t)((((k >= num_ch ? data[k - num_ch] : 0) + delta) &
+					     ADAQ8092_PACK_MASK) << 2) >> 2;
+		}
+
+		pos = next;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Serialize a container header.
+ * @param hdr - The header.
+ * @param buff - Destination of ADAQ8092_PACK_HDR_SIZE bytes.
+ */
+void adaq8092_pack_write_hdr(const struct adaq8092_pack_hdr *hdr,
+			     uint8_t *buff)
+{
+	uint32_t i;
+
+	for (i = 0; i < 4; i++) {
+		buff[i] = ADAQ8092_PACK_MAGIC >> (8 * i);
+		buff[8 + i] = hdr->nb_samples >> (8 * i);
+		buff[12 + i] = hdr->payload_bytes >> (8 * i);
+	}
+
+	buff[4] = ADAQ8092_PACK_VERSION;
+	buff[5] = hdr->format;
+	buff[6] = hdr->num_ch;
+	buff[7] = 0;
+}
+
+/**
+ * @brief Parse a container header.
+ * @param buff - ADAQ8092_PACK_HDR_SIZE bytes.
+ * @param hdr - The header.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_pack_read_hdr(const uint8_t *buff, struct adaq8092_pack_hdr *hdr)
+{
+	uint32_t magic = 0;
+	uint32_t i;
+
+	hdr->nb_samples = 0;
+	hdr->payload_bytes = 0;
+	for (i = 0; i < 4; i++) {
+		magic |= (uint32_t)buff[i] << (8 * i);
+		hdr->nb_samples |= (uint32_t)buff[8 + i] << (8 * i);
+		hdr->payload_bytes |= (uint32_t)buff[12 + i] << (8 * i);
+	}
+
+	if (magic != ADAQ8092_PACK_MAGIC || buff[4] != ADAQ8092_PACK_VERSION ||
+	    buff[5] > ADAQ8092_PACK_DELTA || !buff[6])
+		return -EINVAL;
+
+	hdr->format = buff[5];
+	hdr->num_ch = buff[6];
+
+	return 0;
+}
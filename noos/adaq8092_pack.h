@@ -0,0 +1,121 @@
+/***************************************************************************//**
+ *   @file   adaq8092_pack.h
+ *   @brief  Header file of ADAQ8092 Sample Packing and Compression.
+ *   @author Antoniu Miclaus (antoniu.miclaus@analog.com)
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef __ADAQ8092_PACK_H__
+#define __ADAQ8092_PACK_H__
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* Four 14-bit samples are stored as one little endian 56-bit word */
+#define ADAQ8092_PACK14_GROUP		4
+#define ADAQ8092_PACK14_GROUP_BYTES	7
+
+/* Delta codec: one width byte followed by 64 values of width bits each */
+#define ADAQ8092_DELTA_BLOCK		64
+#define ADAQ8092_DELTA_MAX_WIDTH	14
+#define ADAQ8092_DELTA_BLOCK_MAX_BYTES	(1 + ADAQ8092_DELTA_BLOCK * \
+					 ADAQ8092_DELTA_MAX_WIDTH / 8)
+
+/* Container header, "A8PK" */
+#define ADAQ8092_PACK_MAGIC		0x4B503841
+#define ADAQ8092_PACK_VERSION		1
+#define ADAQ8092_PACK_HDR_SIZE		16
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/* ADAQ8092 Sample Storage Formats */
+enum adaq8092_pack_format {
+	ADAQ8092_PACK_RAW16,
+	ADAQ8092_PACK_PACKED14,
+	ADAQ8092_PACK_DELTA
+};
+
+/**
+ * @struct adaq8092_pack_hdr
+ * @brief ADAQ8092 packed capture header, serialized little endian.
+ */
+struct adaq8092_pack_hdr {
+	enum adaq8092_pack_format	format;
+	/** Number of interleaved channels */
+	uint8_t				num_ch;
+	/** Total number of samples, all channels */
+	uint32_t			nb_samples;
+	/** Number of payload bytes following the header */
+	uint32_t			payload_bytes;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Get the packed size of a block of samples. */
+uint32_t adaq8092_pack14_size(uint32_t nb_samples);
+
+/* Pack 14-bit samples, four samples into seven bytes. */
+void adaq8092_pack14(const int16_t *data, uint8_t *buff, uint32_t nb_samples);
+
+/* Unpack 14-bit samples, sign extending them to 16 bits. */
+void adaq8092_unpack14(const uint8_t *buff, int16_t *data,
+		       uint32_t nb_samples);
+
+/* Get the worst case delta encoded size of a block of samples. */
+uint32_t adaq8092_delta_max_size(uint32_t nb_samples);
+
+/* Delta encode interleaved 14-bit samples. */
+uint32_t adaq8092_delta_encode(const int16_t *data, uint8_t *buff,
+			       uint32_t nb_samples, uint8_t num_ch);
+
+/* Decode delta encoded samples. */
+int adaq8092_delta_decode(const uint8_t *buff, uint32_t nb_bytes,
+			  int16_t *data, uint32_t nb_samples, uint8_t num_ch);
+
+/* Serialize a container header. */
+void adaq8092_pack_write_hdr(const struct adaq8092_pack_hdr *hdr,
+			     uint8_t *buff);
+
+/* Parse a container header. */
+int adaq8092_pack_read_hdr(const uint8_t *buff, struct adaq8092_pack_hdr *hdr);
+
+#endif /* __ADAQ8092_PACK_H__ */
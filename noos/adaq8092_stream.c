@@ -0,0 +1,193 @@
+/***************************************************************************//**
+ *   @file   adaq8092_stream.c
+ *   @brief  Implementation of ADAQ8092 Binary Framed Streaming.
+ *   @author Antoniu Miclaus (antoniu.miclaus@analog.com)
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <string.h>
+#include <errno.h>
+#include "adaq8092_stream.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Compute the CRC-16/CCITT-FALSE of a buffer.
+ * @param data - The data.
+ * @param bytes - Number of bytes.
+ * @param crc - Initial value, 0xFFFF for a new frame.
+ * @return The updated CRC.
+ */
+uint16_t adaq8092_stream_crc16(const uint8_t *data, uint32_t bytes,
+			       uint16_t crc)
+{
+	/* Nibble table for polynomial 0x1021 */
+	static const uint16_t crc_table[16] = {
+		0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+		0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+	};
+	uint32_t i;
+
+	for (i = 0; i < bytes; i++) {
+		crc = (crc << 4) ^ crc_table[(crc >> 12) ^ (data[i] >> 4)];
+		crc = (crc << 4) ^ crc_table[(crc >> 12) ^ (data[i] & 0x0F)];
+	}
+
+	return crc;
+}
+
+/**
+ * @brief Build one frame from interleaved samples.
+ *
+ * Every frame is encoded on its own, so a lost frame does not affect the
+ * decoding of the following ones.
+ *
+ * @param frame - Destination of up to ADAQ8092_STREAM_MAX_FRAME bytes.
+ * @param seq - Frame sequence number.
+ * @param ch_mask - Channels present in data.
+ * @param format - Payload format.
+ * @param data - Interleaved samples.
+ * @param nb_samples - Number of samples, at most ADAQ8092_STREAM_MAX_SAMPLES.
+ * @return Frame size in bytes.
+ */
+uint32_t adaq8092_stream_encode_frame(uint8_t *frame, uint16_t seq,
+				      uint8_t ch_mask,
+				      enum adaq8092_pack_format format,
+				      const int16_t *data, uint16_t nb_samples)
+{
+	uint8_t *payload = &frame[ADAQ8092_STREAM_HDR_SIZE];
+	uint8_t num_ch = (ch_mask & 1) + ((ch_mask >> 1) & 1);
+	uint32_t len, i;
+	uint16_t crc;
+
+	switch (format) {
+	case ADAQ8092_PACK_PACKED14:
+		adaq8092_pack14(data, payload, nb_samples);
+		len = adaq8092_pack14_size(nb_samples);
+		break;
+	case ADAQ8092_PACK_DELTA:
+		len = adaq8092_delta_encode(data, payload, nb_samples, num_ch);
+		break;
+	default:
+		for (i = 0; i < nb_samples; i++) {
+			payload[2 * i] = data[i];
+			payload[2 * i + 1] = (uint16_t)data[i] >> 8;
+		}
+		len = 2 * nb_samples;
+		break;
+	}
+
+	frame[0] = ADAQ8092_STREAM_SYNC & 0xFF;
+	frame[1] = ADAQ8092_STREAM_SYNC >> 8;
+	frame[2] = seq;
+	frame[3] = seq >> 8;
+	frame[4] = ch_mask;
+	frame[5] = format;
+	frame[6] = nb_samples;
+	frame[7] = nb_samples >> 8;
+	frame[8] = len;
+	frame[9] = len >> 8;
+
+	len += ADAQ8092_STREAM_HDR_SIZE;
+	crc = adaq8092_stream_crc16(frame, len, 0xFFFF);
+	frame[len] = crc;
+	frame[len + 1] = crc >> 8;
+
+	return len + ADAQ8092_STREAM_CRC_SIZE;
+}
+
+/**
+ * @brief Initialize the binary stream in caller provided storage.
+ * @param dev - The stream structure, allocated by the caller.
+ * @param init_param - The structure that contains the initial parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_stream_init_static(struct adaq8092_stream_dev *dev,
+				struct adaq8092_stream_init_param *init_param)
+{
+	if (!dev || !init_param->write || !(init_param->ch_mask & 0x3) ||
+	    init_param->ch_mask > 0x3 ||
+	    init_param->format > ADAQ8092_PACK_DELTA)
+		return -EINVAL;
+
+	memset(dev, 0, sizeof(*dev));
+	dev->ch_mask = init_param->ch_mask;
+	dev->num_ch = (dev->ch_mask & 1) + ((dev->ch_mask >> 1) & 1);
+	dev->format = init_param->format;
+	dev->write = init_param->write;
+	dev->ctx = init_param->ctx;
+
+	return 0;
+}
+
+/**
+ * @brief Send interleaved samples as a sequence of frames.
+ * @param dev - The stream structure.
+ * @param data - Interleaved samples of the channels in ch_mask.
+ * @param nb_samples - Number of samples, a multiple of the channel count.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_stream_write(struct adaq8092_stream_dev *dev, const int16_t *data,
+			  uint32_t nb_samples)
+{
+	uint32_t frame_samples = ADAQ8092_STREAM_MAX_SAMPLES -
+				 ADAQ8092_STREAM_MAX_SAMPLES % dev->num_ch;
+	uint32_t n, len;
+	int ret;
+
+	if (nb_samples % dev->num_ch)
+		return -EINVAL;
+
+	while (nb_samples) {
+		n = nb_samples < frame_samples ? nb_samples : frame_samples;
+
+		len = adaq8092_stream_encode_frame(dev->frame, dev->seq++,
+						   dev->ch_mask, dev->format,
+						   data, n);
+		ret = dev->write(dev->ctx, dev->frame, len);
+		if (ret)
+			return ret;
+
+		data += n;
+		nb_samples -= n;
+	}
+
+	return 0;
+}
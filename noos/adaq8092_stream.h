@@ -0,0 +1,120 @@
+/***************************************************************************//**
+ *   @file   adaq8092_stream.h
+ *   @brief  Header file of ADAQ8092 Binary Framed Streaming.
+ *   @author Antoniu Miclaus (antoniu.miclaus@analog.com)
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef __ADAQ8092_STREAM_H__
+#define __ADAQ8092_STREAM_H__
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include "adaq8092_pack.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/*
+ * Frame layout, little endian:
+ * sync(2) seq(2) ch_mask(1) format(1) nb_samples(2) payload_len(2)
+ * payload(payload_len) crc16(2)
+ * The CRC-16/CCITT-FALSE covers everything from sync to the payload end.
+ */
+#define ADAQ8092_STREAM_SYNC		0x92A8
+#define ADAQ8092_STREAM_HDR_SIZE	10
+#define ADAQ8092_STREAM_CRC_SIZE	2
+/* Samples per frame, all channels, a multiple of the packing block sizes */
+#define ADAQ8092_STREAM_MAX_SAMPLES	1024
+#define ADAQ8092_STREAM_MAX_FRAME	(ADAQ8092_STREAM_HDR_SIZE + \
+					 ADAQ8092_STREAM_MAX_SAMPLES * 2 + \
+					 ADAQ8092_STREAM_CRC_SIZE)
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/**
+ * @struct adaq8092_stream_init_param
+ * @brief ADAQ8092 Binary Streaming initialization structure.
+ */
+struct adaq8092_stream_init_param {
+	/** Enabled channels, bit 0 for CH1 and bit 1 for CH2 */
+	uint8_t				ch_mask;
+	enum adaq8092_pack_format	format;
+	/** Transport hook, e.g. a UART write, returns 0 on success */
+	int (*write)(void *ctx, const uint8_t *data, uint32_t bytes);
+	void				*ctx;
+};
+
+/**
+ * @struct adaq8092_stream_dev
+ * @brief ADAQ8092 Binary Streaming structure.
+ */
+struct adaq8092_stream_dev {
+	uint8_t				ch_mask;
+	uint8_t				num_ch;
+	enum adaq8092_pack_format	format;
+	int (*write)(void *ctx, const uint8_t *data, uint32_t bytes);
+	void				*ctx;
+	/** Sequence number of the next frame */
+	uint16_t			seq;
+	/** Frame under construction */
+	uint8_t				frame[ADAQ8092_STREAM_MAX_FRAME];
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Compute the CRC-16/CCITT-FALSE of a buffer. */
+uint16_t adaq8092_stream_crc16(const uint8_t *data, uint32_t bytes,
+			       uint16_t crc);
+
+/* Build one frame from interleaved samples. */
+uint32_t adaq8092_stream_encode_frame(uint8_t *frame, uint16_t seq,
+				      uint8_t ch_mask,
+				      enum adaq8092_pack_format format,
+				      const int16_t *data, uint16_t nb_samples);
+
+/* Initialize the binary stream in caller provided storage. */
+int adaq8092_stream_init_static(struct adaq8092_stream_dev *dev,
+				struct adaq8092_stream_init_param *init_param);
+
+/* Send interleaved samples as a sequence of frames. */
+int adaq8092_stream_write(struct adaq8092_stream_dev *dev, const int16_t *data,
+			  uint32_t nb_samples);
+
+#endif /* __ADAQ8092_STREAM_H__ */
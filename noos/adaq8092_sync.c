@@ -0,0 +1,237 @@
+/***************************************************************************//**
+ *   @file   adaq8092_sync.c
+ *   @brief  Implementation of ADAQ8092 Multi-Board Synchronized Capture.
+ *   @author Antoniu Miclaus (antoniu.miclaus@analog.com)
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <string.h>
+#include <errno.h>
+#include "adaq8092_sync.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Initialize a synchronized group in caller provided storage.
+ * @param group - The group structure, allocated by the caller.
+ * @param init_param - The structure that contains the initial parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_sync_init_static(struct adaq8092_sync_group *group,
+			      struct adaq8092_sync_init_param *init_param)
+{
+	uint8_t i;
+
+	if (!group || !init_param->nb_members ||
+	    init_param->nb_members > ADAQ8092_SYNC_MAX_DEVS ||
+	    init_param->ref_ch >= ADAQ8092_SYNC_NUM_CH)
+		return -EINVAL;
+
+	for (i = 0; i < init_param->nb_members; i++)
+		if (!init_param->member[i].adc || !init_param->member[i].capture)
+			return -EINVAL;
+
+	memset(group, 0, sizeof(*group));
+	memcpy(group->member, init_param->member,
+	       init_param->nb_members * sizeof(*group->member));
+	group->nb_members = init_param->nb_members;
+	group->ref_ch = init_param->ref_ch;
+	group->threshold = init_param->threshold;
+
+	return 0;
+}
+
+/**
+ * @brief Start a capture on every member with a common start.
+ *
+ * The ADC cores are held in reset while the DMA transfers are queued, so no
+ * DMAC sees valid data yet. The resets are then released back to back and
+ * the start skew is a few AXI-Lite writes instead of a full submit. The
+ * remaining offset is measured by adaq8092_sync_align().
+ * @param group - The group structure.
+ * @param address - Capture buffer of each member.
+ * @param bytes - Capture size, the same for every member.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_sync_start(struct adaq8092_sync_group *group,
+			uintptr_t *address, uint32_t bytes)
+{
+	int ret;
+	uint8_t i;
+
+	for (i = 0; i < group->nb_members; i++) {
+		ret = axi_adc_write(group->member[i].adc, AXI_ADC_REG_RSTN,
+				    AXI_ADC_MMCM_RSTN);
+		if (ret)
+			return ret;
+	}
+
+	for (i = 0; i < group->nb_members; i++) {
+		ret = adaq8092_capture_submit(group->member[i].capture,
+					      address[i], bytes, &group->seq[i]);
+		if (ret)
+			return ret;
+	}
+
+	for (i = 0; i < group->nb_members; i++) {
+		ret = axi_adc_write(group->member[i].adc, AXI_ADC_REG_RSTN,
+				    AXI_ADC_MMCM_RSTN | AXI_ADC_RSTN);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Wait for the capture of every member to complete.
+ * @param group - The group structure.
+ * @param timeout - Polling iterations per member, 0 waits forever.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_sync_wait(struct adaq8092_sync_group *group, uint32_t timeout)
+{
+	int ret;
+	uint8_t i;
+
+	for (i = 0; i < group->nb_members; i++) {
+		ret = adaq8092_capture_wait(group->member[i].capture,
+					    group->seq[i], timeout);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Find the first rising crossing of the threshold on the reference
+ * 	  channel.
+ * @param group - The group structure.
+ * @param data - Interleaved capture of one member.
+ * @param nb_samples - Samples per channel.
+ * @return The sample index, -1 if there is no crossing.
+ */
+static int32_t adaq8092_sync_find_edge(struct adaq8092_sync_group *group,
+				       const int16_t *data, uint32_t nb_samples)
+{
+	const int16_t *ref = &data[group->ref_ch];
+	uint32_t i;
+
+	for (i = 1; i < nb_samples; i++)
+		if (ref[(i - 1) * ADAQ8092_SYNC_NUM_CH] < group->threshold &&
+		    ref[i * ADAQ8092_SYNC_NUM_CH] >= group->threshold)
+			return i;
+
+	return -1;
+}
+
+/**
+ * @brief Find the sample offset of every member from the shared alignment
+ * 	  edge.
+ *
+ * Every board must see the same edge (a shared step or trigger pulse) on the
+ * reference channel. The offsets are stored in group->offset[].
+ * @param group - The group structure.
+ * @param data - Interleaved, decoded capture of each member.
+ * @param nb_samples - Samples per channel in each capture.
+ * @return 0 in case of success, -ENOENT if a member has no edge.
+ */
+int adaq8092_sync_align(struct adaq8092_sync_group *group,
+			const int16_t **data, uint32_t nb_samples)
+{
+	int32_t edge[ADAQ8092_SYNC_MAX_DEVS];
+	uint8_t i;
+
+	for (i = 0; i < group->nb_members; i++) {
+		edge[i] = adaq8092_sync_find_edge(group, data[i], nb_samples);
+		if (edge[i] < 0)
+			return -ENOENT;
+	}
+
+	for (i = 0; i < group->nb_members; i++)
+		group->offset[i] = edge[i] - edge[0];
+
+	return 0;
+}
+
+/**
+ * @brief Merge the aligned member captures into one multi-board buffer.
+ *
+ * The output interleaves all channels of all members per sample, member 0
+ * first, and only covers the span every member captured.
+ * @param group - The group structure, aligned by adaq8092_sync_align().
+ * @param data - Interleaved capture of each member.
+ * @param nb_samples - Samples per channel in each capture.
+ * @param out - Merged buffer, nb_members * ADAQ8092_SYNC_NUM_CH * nb_samples
+ * 		long at most.
+ * @return Samples per channel in the merged buffer.
+ */
+uint32_t adaq8092_sync_merge(struct adaq8092_sync_group *group,
+			     const int16_t **data, uint32_t nb_samples,
+			     int16_t *out)
+{
+	const uint32_t stride = group->nb_members * ADAQ8092_SYNC_NUM_CH;
+	int32_t min = 0, max = 0;
+	uint32_t start, len, i, s;
+	uint8_t ch;
+
+	for (i = 0; i < group->nb_members; i++) {
+		if (group->offset[i] < min)
+			min = group->offset[i];
+		if (group->offset[i] > max)
+			max = group->offset[i];
+	}
+
+	if ((uint32_t)(max - min) >= nb_samples)
+		return 0;
+
+	len = nb_samples - (max - min);
+
+	for (i = 0; i < group->nb_members; i++) {
+		start = group->offset[i] - min;
+		for (s = 0; s < len; s++)
+			for (ch = 0; ch < ADAQ8092_SYNC_NUM_CH; ch++)
+				out[s * stride + i * ADAQ8092_SYNC_NUM_CH + ch] =
+					data[i][(start + s) * ADAQ8092_SYNC_NUM_CH + ch];
+	}
+
+	return len;
+}
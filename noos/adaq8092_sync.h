@@ -0,0 +1,124 @@
+/***************************************************************************//**
+ *   @file   adaq8092_sync.h
+ *   @brief  Header file of ADAQ8092 Multi-Board Synchronized Capture.
+ *   @author Antoniu Miclaus (antoniu.miclaus@analog.com)
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef __ADAQ8092_SYNC_H__
+#define __ADAQ8092_SYNC_H__
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include "axi_adc_core.h"
+#include "adaq8092_capture.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* Boards in one synchronized group */
+#define ADAQ8092_SYNC_MAX_DEVS		8
+/* Channels per board, interleaved in the capture buffers */
+#define ADAQ8092_SYNC_NUM_CH		2
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/**
+ * @struct adaq8092_sync_member
+ * @brief One board of a synchronized group.
+ */
+struct adaq8092_sync_member {
+	/** ADC core of the board */
+	struct axi_adc			*adc;
+	/** Interrupt driven capture on the DMA controller of the board */
+	struct adaq8092_capture_dev	*capture;
+};
+
+/**
+ * @struct adaq8092_sync_init_param
+ * @brief ADAQ8092 Synchronized Group initialization structure.
+ */
+struct adaq8092_sync_init_param {
+	struct adaq8092_sync_member	member[ADAQ8092_SYNC_MAX_DEVS];
+	uint8_t				nb_members;
+	/** Channel that sees the shared alignment edge on every board */
+	uint8_t				ref_ch;
+	/** Rising edge level of the shared alignment signal */
+	int16_t				threshold;
+};
+
+/**
+ * @struct adaq8092_sync_group
+ * @brief ADAQ8092 Synchronized Group structure.
+ */
+struct adaq8092_sync_group {
+	struct adaq8092_sync_member	member[ADAQ8092_SYNC_MAX_DEVS];
+	uint8_t				nb_members;
+	uint8_t				ref_ch;
+	int16_t				threshold;
+	/** Capture sequence number of the last start, per member */
+	uint32_t			seq[ADAQ8092_SYNC_MAX_DEVS];
+	/** Alignment edge position relative to member 0, in samples per channel */
+	int32_t				offset[ADAQ8092_SYNC_MAX_DEVS];
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Initialize a synchronized group in caller provided storage. */
+int adaq8092_sync_init_static(struct adaq8092_sync_group *group,
+			      struct adaq8092_sync_init_param *init_param);
+
+/* Start a capture on every member with a common start. */
+int adaq8092_sync_start(struct adaq8092_sync_group *group,
+			uintptr_t *address, uint32_t bytes);
+
+/* Wait for the capture of every member to complete. */
+int adaq8092_sync_wait(struct adaq8092_sync_group *group, uint32_t timeout);
+
+/* Find the sample offset of every member from the shared alignment edge. */
+int adaq8092_sync_align(struct adaq8092_sync_group *group,
+			const int16_t **data, uint32_t nb_samples);
+
+/* Merge the aligned member captures into one multi-board buffer. */
+uint32_t adaq8092_sync_merge(struct adaq8092_sync_group *group,
+			     const int16_t **data, uint32_t nb_samples,
+			     int16_t *out);
+
+#endif /* __ADAQ8092_SYNC_H__ */
@@ -0,0 +1,536 @@
+/***************************************************************************//**
+ *   @file   adaq8092_trigger.c
+ *   @brief  Implementation of ADAQ8092 Triggered Capture.
+ *   @author Antoniu Miclaus (antoniu.miclaus@analog.com)
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#ifndef ADAQ8092_STATIC_ALLOC
+#include <stdlib.h>
+#endif
+#include <string.h>
+#include <errno.h>
+#include "adaq8092_trigger.h"
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Evaluate the trigger condition on a single sample.
+ * @param cond - The trigger condition.
+ * @param prev - The previous sample of the trigger channel.
+ * @param x - The current sample of the trigger channel.
+ * @return true if the condition is met, false otherwise.
+ */
+static bool adaq8092_trig_match(const struct adaq8092_trig_cond *cond,
+				int16_t prev, int16_t x)
+{
+	bool rising = cond->polarity == ADAQ8092_TRIG_RISING;
+
+	switch (cond->type) {
+	case ADAQ8092_TRIG_LEVEL:
+		return rising ? x >= cond->level : x <= cond->level;
+	case ADAQ8092_TRIG_EDGE:
+		if (rising)
+			return prev < cond->level && x >= cond->level;
+		return prev > cond->level && x <= cond->level;
+	case ADAQ8092_TRIG_SLOPE:
+		if (rising)
+			return (int32_t)x - prev >= cond->slope;
+		return (int32_t)prev - x >= cond->slope;
+	default:
+		return false;
+	}
+}
+
+#ifdef __ARM_NEON
+/**
+ * @brief Evaluate the trigger condition on eight samples at once.
+ * @param cond - The trigger condition.
+ * @param prev - The previous sample of each lane.
+ * @param x - The current samples.
+ * @return Lane mask, all ones where the condition is met.
+ */
+static uint16x8_t adaq8092_trig_match_vec(const struct adaq8092_trig_cond *cond,
+		int16x8_t prev, int16x8_t x)
+{
+	int16x8_t level = vdupq_n_s16(cond->level);
+	int32x4_t slope = vdupq_n_s32(cond->slope);
+	bool rising = cond->polarity == ADAQ8092_TRIG_RISING;
+	int16x8_t from = rising ? prev : x;
+	int16x8_t to = rising ? x : prev;
+	int32x4_t lo, hi;
+
+	switch (cond->type) {
+	case ADAQ8092_TRIG_LEVEL:
+		return rising ? vcgeq_s16(x, level) : vcleq_s16(x, level);
+	case ADAQ8092_TRIG_EDGE:
+		if (rising)
+			return vandq_u16(vcltq_s16(prev, level), vcgeq_s16(x, level));
+		return vandq_u16(vcgtq_s16(prev, level), vcleq_s16(x, level));
+	case ADAQ8092_TRIG_SLOPE:
+		/* Widened to 32 bits like the scalar path, exact for any slope. */
+		lo = vsubl_s16(vget_low_s16(to), vget_low_s16(from));
+		hi = vsubl_s16(vget_high_s16(to), vget_high_s16(from));
+		return vcombine_u16(vmovn_u32(vcgeq_s32(lo, slope)),
+				    vmovn_u32(vcgeq_s32(hi, slope)));
+	default:
+		return vdupq_n_u16(0);
+	}
+}
+#endif
+
+/**
+ * @brief Find the first sample of a block matching the trigger condition.
+ * @param data - Interleaved CH1/CH2 samples.
+ * @param nb_samples - Number of samples per channel in the block.
+ * @param cond - The trigger condition.
+ * @param prev - The trigger channel sample preceding the block.
+ * @return Index of the matching sample, -1 if there is none.
+ */
+int32_t adaq8092_trig_scan(const int16_t *data, uint32_t nb_samples,
+			   const struct adaq8092_trig_cond *cond, int16_t prev)
+{
+	uint32_t i = 0;
+	int16_t x;
+
+#ifdef __ARM_NEON
+	int16x8_t last = vdupq_n_s16(prev);
+	int16x8x2_t pair;
+	uint16x8_t hit;
+	uint16x4_t any;
+
+	/* Stop at the first group of eight holding a match, resolved below. */
+	for (; i + 8 <= nb_samples; i += 8) {
+		pair = vld2q_s16(&data[i * ADAQ8092_TRIG_NUM_CH]);
+		hit = adaq8092_trig_match_vec(cond,
+					      vextq_s16(last, pair.val[cond->channel], 7),
+					      pair.val[cond->channel]);
+		any = vorr_u16(vget_low_u16(hit), vget_high_u16(hit));
+		if (vget_lane_u64(vreinterpret_u64_u16(any), 0))
+			break;
+
+		last = pair.val[cond->channel];
+	}
+
+	if (i)
+		prev = data[(i - 1) * ADAQ8092_TRIG_NUM_CH + cond->channel];
+#endif
+
+	for (; i < nb_samples; i++) {
+		x = data[i * ADAQ8092_TRIG_NUM_CH + cond->channel];
+		if (adaq8092_trig_match(cond, prev, x))
+			return i;
+
+		prev = x;
+	}
+
+	return -1;
+}
+
+/**
+ * @brief Count the trigger events in a block while the engine is not armed.
+ * @param data - Interleaved CH1/CH2 samples.
+ * @param nb_samples - Number of samples per channel in the block.
+ * @param cond - The trigger condition.
+ * @param prev - The trigger channel sample preceding the block.
+ * @param active - Whether the sample preceding the block met the condition,
+ *                 updated to the state of the last sample of the block.
+ * @return Number of condition onsets found in the block.
+ */
+static uint32_t adaq8092_trig_count(const int16_t *data, uint32_t nb_samples,
+				    const struct adaq8092_trig_cond *cond,
+				    int16_t prev, bool *active)
+{
+	uint32_t i, count = 0;
+	bool hit;
+	int16_t x;
+
+	for (i = 0; i < nb_samples; i++) {
+		x = data[i * ADAQ8092_TRIG_NUM_CH + cond->channel];
+		hit = adaq8092_trig_match(cond, prev, x);
+		if (hit && !*active)
+			count++;
+
+		*active = hit;
+		prev = x;
+	}
+
+	return count;
+}
+
+/**
+ * @brief Reset a threshold detector to the saturated codes of both channels.
+ * @param thresh - The threshold detector.
+ */
+void adaq8092_thresh_init(struct adaq8092_thresh *thresh)
+{
+	uint8_t ch;
+
+	memset(thresh, 0, sizeof(*thresh));
+
+	for (ch = 0; ch < ADAQ8092_TRIG_NUM_CH; ch++) {
+		thresh->low[ch] = ADAQ8092_THRESH_CODE_MIN;
+		thresh->high[ch] = ADAQ8092_THRESH_CODE_MAX;
+	}
+}
+
+/**
+ * @brief Set the threshold window of a channel.
+ * @param thresh - The threshold detector.
+ * @param channel - Channel the window applies to (0 or 1).
+ * @param low - Samples at or below are out of range, in ADC codes.
+ * @param high - Samples at or above are out of range, in ADC codes.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_thresh_set(struct adaq8092_thresh *thresh, uint8_t channel,
+			int16_t low, int16_t high)
+{
+	if (channel >= ADAQ8092_TRIG_NUM_CH || low >= high)
+		return -EINVAL;
+
+	thresh->low[channel] = low;
+	thresh->high[channel] = high;
+
+	return 0;
+}
+
+/**
+ * @brief Count the out of range excursions of a block.
+ *
+ * An excursion starts with the first sample at or beyond the window and lasts
+ * until a sample is back inside, also across blocks, so a saturated stretch
+ * is counted once.
+ *
+ * @param thresh - The threshold detector.
+ * @param data - Interleaved CH1/CH2 samples.
+ * @param nb_samples - Number of samples per channel in the block.
+ * @param pos - Absolute sample index of the first sample of the block.
+ * @return Mask of the channels with a new excursion, bit 0 for CH1.
+ */
+uint8_t adaq8092_thresh_scan(struct adaq8092_thresh *thresh,
+			     const int16_t *data, uint32_t nb_samples,
+			     uint64_t pos)
+{
+	uint32_t i = 0, end;
+	uint8_t ch, mask = 0;
+	bool out;
+	int16_t x;
+
+#ifdef __ARM_NEON
+	int16x8_t low0 = vdupq_n_s16(thresh->low[0]);
+	int16x8_t low1 = vdupq_n_s16(thresh->low[1]);
+	int16x8_t high0 = vdupq_n_s16(thresh->high[0]);
+	int16x8_t high1 = vdupq_n_s16(thresh->high[1]);
+	int16x8x2_t pair;
+	uint16x8_t hit;
+	uint16x4_t any;
+#endif
+
+	while (i < nb_samples) {
+		end = nb_samples;
+
+#ifdef __ARM_NEON
+		/* Skip groups of eight in range, an excursion always ends there. */
+		for (; i + 8 <= nb_samples; i += 8) {
+			pair = vld2q_s16(&data[i * ADAQ8092_TRIG_NUM_CH]);
+			hit = vorrq_u16(vorrq_u16(vcleq_s16(pair.val[0], low0),
+						  vcgeq_s16(pair.val[0], high0)),
+					vorrq_u16(vcleq_s16(pair.val[1], low1),
+						  vcgeq_s16(pair.val[1], high1)));
+			any = vorr_u16(vget_low_u16(hit), vget_high_u16(hit));
+			if (vget_lane_u64(vreinterpret_u64_u16(any), 0))
+				break;
+
+			thresh->active[0] = false;
+			thresh->active[1] = false;
+		}
+
+		/* Resolve the group holding an excursion sample by sample. */
+		end = i + 8 <= nb_samples ? i + 8 : nb_samples;
+#endif
+
+		for (; i < end; i++) {
+			for (ch = 0; ch < ADAQ8092_TRIG_NUM_CH; ch++) {
+				x = data[i * ADAQ8092_TRIG_NUM_CH + ch];
+				out = x <= thresh->low[ch] || x >= thresh->high[ch];
+				if (out && !thresh->active[ch]) {
+					thresh->count[ch]++;
+					thresh->last_pos[ch] = pos + i;
+					mask |= 1 << ch;
+				}
+
+				thresh->active[ch] = out;
+			}
+		}
+	}
+
+	return mask;
+}
+
+/**
+ * @brief Copy the pre/post-trigger window out of the circular buffer.
+ * @param dev - The triggered capture structure.
+ * @param buff - Destination for (pre + post) interleaved sample pairs.
+ * @param pos - Trigger position.
+ */
+static void adaq8092_trig_freeze(struct adaq8092_trig_dev *dev, int16_t *buff,
+				 uint64_t pos)
+{
+	uint32_t ring_samples = dev->block_samples * dev->num_blocks;
+	uint32_t len = dev->pre_samples + dev->post_samples;
+	uint32_t first, chunk;
+
+	first = (pos - dev->pre_samples) % ring_samples;
+	chunk = ring_samples - first;
+	if (chunk > len)
+		chunk = len;
+
+	memcpy(buff, &dev->ring[first * ADAQ8092_TRIG_NUM_CH],
+	       chunk * ADAQ8092_TRIG_NUM_CH * sizeof(*buff));
+	memcpy(&buff[chunk * ADAQ8092_TRIG_NUM_CH], dev->ring,
+	       (len - chunk) * ADAQ8092_TRIG_NUM_CH * sizeof(*buff));
+}
+
+/**
+ * @brief Update the trigger condition.
+ * @param dev - The triggered capture structure.
+ * @param cond - The new trigger condition.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_trig_set_cond(struct adaq8092_trig_dev *dev,
+			   struct adaq8092_trig_cond *cond)
+{
+	if (cond->channel >= ADAQ8092_TRIG_NUM_CH)
+		return -EINVAL;
+
+	dev->cond = *cond;
+	dev->active = false;
+
+	return 0;
+}
+
+/**
+ * @brief Initialize the triggered capture engine in caller provided storage.
+ * @param dev - The triggered capture structure, allocated by the caller.
+ * @param init_param - The structure that contains the initial parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_trig_init_static(struct adaq8092_trig_dev *dev,
+			      struct adaq8092_trig_init_param *init_param)
+{
+	uint32_t ring_samples;
+	int ret;
+
+	if (!dev || !init_param->dmac || !init_param->ring ||
+	    !init_param->block_samples || !init_param->num_blocks)
+		return -EINVAL;
+
+	/* The pre-trigger history must survive until the post window is full. */
+	ring_samples = init_param->block_samples * init_param->num_blocks;
+	if (ring_samples < init_param->pre_samples + init_param->post_samples +
+	    init_param->block_samples)
+		return -EINVAL;
+
+	memset(dev, 0, sizeof(*dev));
+
+	ret = adaq8092_trig_set_cond(dev, &init_param->cond);
+	if (ret)
+		return ret;
+
+	dev->dmac = init_param->dmac;
+	dev->ring = init_param->ring;
+	dev->block_samples = init_param->block_samples;
+	dev->num_blocks = init_param->num_blocks;
+	dev->pre_samples = init_param->pre_samples;
+	dev->post_samples = init_param->post_samples;
+	dev->thresh = init_param->thresh;
+	dev->dcache_invalidate_range = init_param->dcache_invalidate_range;
+
+	return 0;
+}
+
+#ifndef ADAQ8092_STATIC_ALLOC
+/**
+ * @brief Initialize the triggered capture engine.
+ * @param device - The triggered capture structure.
+ * @param init_param - The structure that contains the initial parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_trig_init(struct adaq8092_trig_dev **device,
+		       struct adaq8092_trig_init_param *init_param)
+{
+	struct adaq8092_trig_dev *dev;
+	int ret;
+
+	dev = (struct adaq8092_trig_dev *)calloc(1, sizeof(*dev));
+	if (!dev)
+		return -ENOMEM;
+
+	ret = adaq8092_trig_init_static(dev, init_param);
+	if (ret) {
+		free(dev);
+		return ret;
+	}
+
+	*device = dev;
+
+	return 0;
+}
+
+/**
+ * @brief Remove the triggered capture engine.
+ * @param dev - The triggered capture structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int adaq8092_trig_remove(struct adaq8092_trig_dev *dev)
+{
+	if (!dev)
+		return -EINVAL;
+
+	free(dev);
+
+	return 0;
+}
+#endif
+
+/**
+ * @brief Stream blocks until a trigger fires and freeze the pre/post window.
+ *
+ * Blocks are transferred back to back into the circular buffer and scanned
+ * as they complete. The engine only arms once pre_samples of history have
+ * been collected in the current run; triggers seen while a window is being
+ * completed or before the engine re-arms are accounted in missed_count.
+ * The optional threshold detector sees every block, armed or not.
+ *
+ * @param dev - The triggered capture structure.
+ * @param buff - Destination for (pre + post) interleaved sample pairs.
+ * @param max_blocks - Maximum number of blocks to wait for a trigger.
+ * @param trig_pos - Absolute sample index of the trigger.
+ * @return 0 in case of success, -ETIMEDOUT if no trigger fired, negative
+ *         error code otherwise.
+ */
+int adaq8092_trig_capture(struct adaq8092_trig_dev *dev, int16_t *buff,
+			  uint32_t max_blocks, uint64_t *trig_pos)
+{
+	uint32_t block_bytes = dev->block_samples * ADAQ8092_TRIG_NUM_CH *
+			       sizeof(*dev->ring);
+	uint32_t n = dev->block_samples;
+	uint8_t ch = dev->cond.channel;
+	uint32_t blk, slot, start, next;
+	bool triggered = false;
+	uint64_t pos = 0;
+	int16_t *block;
+	int32_t idx;
+	int ret;
+
+	/* The DMA restarts here, so the pre-trigger history is rebuilt. */
+	dev->armed_at = dev->sample_count + dev->pre_samples;
+	if (dev->trig_count)
+		dev->rearm_latency = dev->armed_at - dev->freeze_end;
+
+	for (blk = 0; blk < max_blocks; blk++) {
+		slot = (dev->sample_count / n) % dev->num_blocks;
+		block = &dev->ring[slot * n * ADAQ8092_TRIG_NUM_CH];
+
+		ret = axi_dmac_transfer(dev->dmac, (uintptr_t)block, block_bytes);
+		if (ret)
+			return ret;
+
+		if (dev->dcache_invalidate_range)
+			dev->dcache_invalidate_range((uintptr_t)block, block_bytes);
+
+		if (dev->thresh)
+			adaq8092_thresh_scan(dev->thresh, block, n, dev->sample_count);
+
+		if (triggered) {
+			dev->missed_count += adaq8092_trig_count(block, n, &dev->cond,
+					     dev->prev, &dev->active);
+		} else {
+			start = 0;
+			if (dev->armed_at > dev->sample_count)
+				start = dev->armed_at - dev->sample_count < n ?
+					dev->armed_at - dev->sample_count : n;
+
+			if (start && dev->trig_count)
+				dev->missed_count += adaq8092_trig_count(block, start,
+						     &dev->cond, dev->prev,
+						     &dev->active);
+
+			if (start < n) {
+				idx = adaq8092_trig_scan(&block[start * ADAQ8092_TRIG_NUM_CH],
+							 n - start, &dev->cond,
+							 start ? block[(start - 1) *
+							       ADAQ8092_TRIG_NUM_CH + ch] :
+							 dev->prev);
+				/* The scan stops at the first match */
+				dev->active = idx >= 0;
+				if (idx >= 0) {
+					triggered = true;
+					pos = dev->sample_count + start + idx;
+					next = start + idx + 1;
+					dev->missed_count += adaq8092_trig_count(
+								     &block[next * ADAQ8092_TRIG_NUM_CH],
+								     n - next, &dev->cond,
+								     block[(next - 1) * ADAQ8092_TRIG_NUM_CH + ch],
+								     &dev->active);
+				}
+			}
+		}
+
+		dev->prev = block[(n - 1) * ADAQ8092_TRIG_NUM_CH + ch];
+		dev->sample_count += n;
+
+		if (triggered && dev->sample_count >= pos + dev->post_samples) {
+			adaq8092_trig_freeze(dev, buff, pos);
+			dev->freeze_end = pos + dev->post_samples;
+			dev->armed_at = dev->sample_count;
+			dev->trig_count++;
+			*trig_pos = pos;
+
+			return 0;
+		}
+	}
+
+	return -ETIMEDOUT;
+}
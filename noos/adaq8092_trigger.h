@@ -0,0 +1,202 @@
+/***************************************************************************//**
+ *   @file   adaq8092_trigger.h
+ *   @brief  Header file of ADAQ8092 Triggered Capture.
+ *   @author Antoniu Miclaus (antoniu.miclaus@analog.com)
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef __ADAQ8092_TRIGGER_H__
+#define __ADAQ8092_TRIGGER_H__
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "axi_dmac.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define ADAQ8092_TRIG_NUM_CH		2
+/* Saturated codes of the 14-bit range, the default threshold window */
+#define ADAQ8092_THRESH_CODE_MIN	-8192
+#define ADAQ8092_THRESH_CODE_MAX	8191
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/* ADAQ8092 Trigger Condition Type */
+enum adaq8092_trig_type {
+	ADAQ8092_TRIG_LEVEL,
+	ADAQ8092_TRIG_EDGE,
+	ADAQ8092_TRIG_SLOPE
+};
+
+/* ADAQ8092 Trigger Polarity */
+enum adaq8092_trig_polarity {
+	ADAQ8092_TRIG_RISING,
+	ADAQ8092_TRIG_FALLING
+};
+
+/**
+ * @struct adaq8092_trig_cond
+ * @brief ADAQ8092 Trigger condition.
+ */
+struct adaq8092_trig_cond {
+	/** Channel the condition is evaluated on (0 or 1) */
+	uint8_t				channel;
+	enum adaq8092_trig_type		type;
+	enum adaq8092_trig_polarity	polarity;
+	/** Threshold for level and edge conditions, in ADC codes */
+	int16_t				level;
+	/** Minimum sample-to-sample step for slope conditions, in ADC codes */
+	int16_t				slope;
+};
+
+/**
+ * @struct adaq8092_thresh
+ * @brief ADAQ8092 per channel threshold detector.
+ */
+struct adaq8092_thresh {
+	/** Samples at or below are out of range, in ADC codes */
+	int16_t				low[ADAQ8092_TRIG_NUM_CH];
+	/** Samples at or above are out of range, in ADC codes */
+	int16_t				high[ADAQ8092_TRIG_NUM_CH];
+	/** Whether the last scanned sample was out of range */
+	bool				active[ADAQ8092_TRIG_NUM_CH];
+	/** Out of range excursions seen so far */
+	uint32_t			count[ADAQ8092_TRIG_NUM_CH];
+	/** Absolute sample index of the last excursion onset */
+	uint64_t			last_pos[ADAQ8092_TRIG_NUM_CH];
+};
+
+/**
+ * @struct adaq8092_trig_init_param
+ * @brief ADAQ8092 Triggered Capture initialization structure.
+ */
+struct adaq8092_trig_init_param {
+	/** DMA controller feeding the circular buffer */
+	struct axi_dmac			*dmac;
+	/** Interleaved circular buffer of num_blocks * block_samples pairs */
+	int16_t				*ring;
+	/** Samples per channel transferred by one DMA block */
+	uint32_t			block_samples;
+	/** Number of DMA blocks in the circular buffer */
+	uint32_t			num_blocks;
+	/** Samples per channel kept before the trigger point */
+	uint32_t			pre_samples;
+	/** Samples per channel kept from the trigger point onwards */
+	uint32_t			post_samples;
+	struct adaq8092_trig_cond	cond;
+	/** Optional threshold detector run on every DMA block */
+	struct adaq8092_thresh		*thresh;
+	/** Cache invalidation hook, called after every DMA block */
+	void (*dcache_invalidate_range)(uint32_t address, uint32_t bytes_count);
+};
+
+/**
+ * @struct adaq8092_trig_dev
+ * @brief ADAQ8092 Triggered Capture structure.
+ */
+struct adaq8092_trig_dev {
+	struct axi_dmac			*dmac;
+	int16_t				*ring;
+	uint32_t			block_samples;
+	uint32_t			num_blocks;
+	uint32_t			pre_samples;
+	uint32_t			post_samples;
+	struct adaq8092_trig_cond	cond;
+	struct adaq8092_thresh		*thresh;
+	void (*dcache_invalidate_range)(uint32_t address, uint32_t bytes_count);
+	/** Samples per channel written to the circular buffer so far */
+	uint64_t			sample_count;
+	/** First sample index at which a new trigger is accepted */
+	uint64_t			armed_at;
+	/** Sample index following the last frozen post-trigger window */
+	uint64_t			freeze_end;
+	/** Last trigger channel sample of the previous block */
+	int16_t				prev;
+	/** Whether that sample met the trigger condition */
+	bool				active;
+	/** Number of triggers frozen so far */
+	uint32_t			trig_count;
+	/** Triggers that fired while a capture was frozen or not yet re-armed */
+	uint32_t			missed_count;
+	/** Samples between the end of the last capture and the re-arm point */
+	uint32_t			rearm_latency;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Find the first sample of a block matching the trigger condition. */
+int32_t adaq8092_trig_scan(const int16_t *data, uint32_t nb_samples,
+			   const struct adaq8092_trig_cond *cond, int16_t prev);
+
+/* Reset a threshold detector to the saturated codes of both channels. */
+void adaq8092_thresh_init(struct adaq8092_thresh *thresh);
+
+/* Set the threshold window of a channel. */
+int adaq8092_thresh_set(struct adaq8092_thresh *thresh, uint8_t channel,
+			int16_t low, int16_t high);
+
+/* Count the out of range excursions of a block. */
+uint8_t adaq8092_thresh_scan(struct adaq8092_thresh *thresh,
+			     const int16_t *data, uint32_t nb_samples,
+			     uint64_t pos);
+
+/* Initialize the triggered capture engine in caller provided storage. */
+int adaq8092_trig_init_static(struct adaq8092_trig_dev *dev,
+			      struct adaq8092_trig_init_param *init_param);
+
+#ifndef ADAQ8092_STATIC_ALLOC
+/* Initialize the triggered capture engine. */
+int adaq8092_trig_init(struct adaq8092_trig_dev **device,
+		       struct adaq8092_trig_init_param *init_param);
+
+/* Remove the triggered capture engine. */
+int adaq8092_trig_remove(struct adaq8092_trig_dev *dev);
+#endif
+
+/* Update the trigger condition. */
+int adaq8092_trig_set_cond(struct adaq8092_trig_dev *dev,
+			   struct adaq8092_trig_cond *cond);
+
+/* Stream blocks until a trigger fires and freeze the pre/post window. */
+int adaq8092_trig_capture(struct adaq8092_trig_dev *dev, int16_t *buff,
+			  uint32_t max_blocks, uint64_t *trig_pos);
+
+#endif /* __ADAQ8092_TRIGGER_H__ */
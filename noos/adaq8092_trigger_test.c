@@ -0,0 +1,232 @@
+/***************************************************************************//**
+ *   @file   adaq8092_trigger_test.c
+ *   @brief  Host tests of the ADAQ8092 Triggered Capture.
+ *   @author Antoniu Miclaus (antoniu.miclaus@analog.com)
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*
+ * Built on the host against the driver sources, with the DMA controller
+ * replaced by the stream below. On an Arm host with NEON the scans run the
+ * vector path, checked against the scalar reference of this file:
+ *   cc -I. -I<no-OS>/drivers/axi_core/axi_dmac -o adaq8092_trigger_test \
+ *	adaq8092_trigger_test.c adaq8092_trigger.c
+ */
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "adaq8092_trigger.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define TEST_BLOCK_SAMPLES	8
+#define TEST_NUM_BLOCKS		4
+#define TEST_POST_SAMPLES	8
+
+#ifndef ARRAY_SIZE
+#define ARRAY_SIZE(x)		(sizeof(x) / sizeof((x)[0]))
+#endif
+
+#define TEST_EXPECT(cond) do {						\
+	if (!(cond)) {							\
+		printf("%s:%d: %s\n", __func__, __LINE__, #cond);	\
+		return 1;						\
+	}								\
+} while (0)
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+static struct adaq8092_trig_dev test_trig;
+static const int16_t *test_stream;
+static uint32_t test_stream_samples;
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Fake DMA transfer, copies the next block of the test stream to the
+ *        ring slot the capture engine is about to scan.
+ * @param dmac - Unused.
+ * @param address - Unused, the slot is derived from the engine state.
+ * @param size - Transfer size in bytes.
+ * @return 0 in case of success, -1 once the stream is exhausted.
+ */
+int32_t axi_dmac_transfer(struct axi_dmac *dmac, uint32_t address,
+			  uint32_t size)
+{
+	uint32_t n = test_trig.block_samples;
+	uint32_t slot = (test_trig.sample_count / n) % test_trig.num_blocks;
+	int16_t *block = &test_trig.ring[slot * n * ADAQ8092_TRIG_NUM_CH];
+	uint32_t i;
+
+	(void)dmac;
+	(void)address;
+	(void)size;
+
+	if (test_trig.sample_count + n > test_stream_samples)
+		return -1;
+
+	for (i = 0; i < n; i++) {
+		block[i * ADAQ8092_TRIG_NUM_CH] =
+			test_stream[test_trig.sample_count + i];
+		block[i * ADAQ8092_TRIG_NUM_CH + 1] = 0;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief A level held across a block boundary is a single event, only the
+ *        onset in the second block counts as missed.
+ * @return 0 in case of success, 1 otherwise.
+ */
+static int test_trig_level_held_across_blocks(void)
+{
+	static const int16_t stream[2 * TEST_BLOCK_SAMPLES] = {
+		/* Fires on sample 3 and stays high to the end of the block */
+		0, 0, 0, 200, 200, 200, 200, 200,
+		/* Still high across the boundary, then one new onset */
+		200, 200, 0, 0, 200, 0, 0, 0,
+	};
+	static int16_t ring[TEST_BLOCK_SAMPLES * TEST_NUM_BLOCKS *
+			    ADAQ8092_TRIG_NUM_CH];
+	static int16_t buff[TEST_POST_SAMPLES * ADAQ8092_TRIG_NUM_CH];
+	struct axi_dmac dmac = { 0 };
+	struct adaq8092_trig_init_param init_param = {
+		.dmac = &dmac,
+		.ring = ring,
+		.block_samples = TEST_BLOCK_SAMPLES,
+		.num_blocks = TEST_NUM_BLOCKS,
+		.post_samples = TEST_POST_SAMPLES,
+		.cond = {
+			.type = ADAQ8092_TRIG_LEVEL,
+			.polarity = ADAQ8092_TRIG_RISING,
+			.level = 100,
+		},
+	};
+	uint64_t pos;
+
+	test_stream = stream;
+	test_stream_samples = 2 * TEST_BLOCK_SAMPLES;
+
+	TEST_EXPECT(!adaq8092_trig_init_static(&test_trig, &init_param));
+	TEST_EXPECT(!adaq8092_trig_capture(&test_trig, buff, 2, &pos));
+	TEST_EXPECT(pos == 3);
+	TEST_EXPECT(test_trig.missed_count == 1);
+
+	return 0;
+}
+
+/**
+ * @brief Scalar slope reference, sample differences taken in 32 bits.
+ * @param cond - The trigger condition.
+ * @param prev - The previous sample.
+ * @param x - The current sample.
+ * @return true if the condition is met, false otherwise.
+ */
+static bool test_trig_slope_ref(const struct adaq8092_trig_cond *cond,
+				int16_t prev, int16_t x)
+{
+	if (cond->polarity == ADAQ8092_TRIG_RISING)
+		return (int32_t)x - prev >= cond->slope;
+
+	return (int32_t)prev - x >= cond->slope;
+}
+
+/**
+ * @brief Slope thresholds near full scale, where a 16-bit difference would
+ *        saturate, find the same onset on the vector and the scalar path.
+ * @return 0 in case of success, 1 otherwise.
+ */
+static int test_trig_slope_full_scale(void)
+{
+	static const int16_t slopes[] = { INT16_MIN, -1, 0, INT16_MAX };
+	static const int16_t prevs[] = { INT16_MIN, 0, INT16_MAX };
+	/* Long enough for two groups of eight on the vector path */
+	int16_t data[2 * TEST_BLOCK_SAMPLES * ADAQ8092_TRIG_NUM_CH] = { 0 };
+	struct adaq8092_trig_cond cond = { .type = ADAQ8092_TRIG_SLOPE };
+	uint32_t i, s, p, phase;
+	int32_t expected;
+	int16_t prev;
+
+	for (phase = 0; phase < 2; phase++) {
+		/* Full scale square wave, every step overflows 16 bits */
+		for (i = 0; i < 2 * TEST_BLOCK_SAMPLES; i++)
+			data[i * ADAQ8092_TRIG_NUM_CH] = (i + phase) % 2 ?
+							 INT16_MAX : INT16_MIN;
+
+		for (s = 0; s < 2 * ARRAY_SIZE(slopes); s++) {
+			cond.polarity = s % 2 ? ADAQ8092_TRIG_FALLING :
+					ADAQ8092_TRIG_RISING;
+			cond.slope = slopes[s / 2];
+
+			for (p = 0; p < ARRAY_SIZE(prevs); p++) {
+				expected = -1;
+				prev = prevs[p];
+				for (i = 0; i < 2 * TEST_BLOCK_SAMPLES; i++) {
+					if (test_trig_slope_ref(&cond, prev,
+								data[i * ADAQ8092_TRIG_NUM_CH])) {
+						expected = i;
+						break;
+					}
+					prev = data[i * ADAQ8092_TRIG_NUM_CH];
+				}
+
+				TEST_EXPECT(adaq8092_trig_scan(data, 2 * TEST_BLOCK_SAMPLES,
+							       &cond, prevs[p]) == expected);
+			}
+		}
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	int ret = 0;
+
+	ret |= test_trig_level_held_across_blocks();
+	ret |= test_trig_slope_full_scale();
+
+	printf("adaq8092_trigger_test: %s\n", ret ? "FAIL" : "PASS");
+
+	return ret;
+}
@@ -42,5 +42,11 @@
 
 //#define XILINX_PLATFORM
 //#define IIO_SUPPORT
+//#define TRIGGER_SUPPORT
+//#define DECIMATION_SUPPORT
+//#define PACK_SUPPORT
+//#define DMA_IRQ_SUPPORT
+//#define STREAM_SUPPORT
+//#define SYNC_SUPPORT
 
 #endif /* APP_CONFIG_H_ */
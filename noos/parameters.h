@@ -45,9 +45,12 @@
 #define SPI_DEVICE_ID				XPAR_PS7_SPI_0_DEVICE_ID
 #define RX_CORE_BASEADDR			XPAR_AXI_ADAQ8092_BASEADDR
 #define RX_DMA_BASEADDR				XPAR_AXI_ADAQ8092_DMA_BASEADDR
+#define RX_DMA_IRQ_ID				XPAR_FABRIC_AXI_ADAQ8092_DMA_IRQ_INTR
 #define UART_DEVICE_ID				XPAR_XUARTPS_0_DEVICE_ID
 #define UART_IRQ_ID				XPAR_XUARTPS_1_INTR
 #define UART_BAUDRATE                           115200
+/* Binary capture stream, the highest rate of the on-board USB-UART bridge */
+#define ADAQ8092_STREAM_BAUDRATE		921600
 #define INTC_DEVICE_ID				XPAR_SCUGIC_SINGLE_DEVICE_ID
 
 #define GPIO_DEVICE_ID				XPAR_PS7_GPIO_0_DEVICE_ID
@@ -58,4 +61,26 @@
 #define GPIO_PD2_NR			    	GPIO_OFFSET+2
 #define GPIO_1V8_NR			   	GPIO_OFFSET+3
 
+/* Second ADAQ8092 FMC of dual board HDL builds, used by SYNC_SUPPORT */
+#define SPI_CS_1				1
+#define GPIO_PAR_SER_NR_1			GPIO_OFFSET+4
+#define GPIO_PD1_NR_1				GPIO_OFFSET+5
+#define GPIO_PD2_NR_1				GPIO_OFFSET+6
+#define GPIO_1V8_NR_1				GPIO_OFFSET+7
+#define RX_CORE_BASEADDR_1			XPAR_AXI_ADAQ8092_1_BASEADDR
+#define RX_DMA_BASEADDR_1			XPAR_AXI_ADAQ8092_1_DMA_BASEADDR
+#define RX_DMA_IRQ_ID_1				XPAR_FABRIC_AXI_ADAQ8092_1_DMA_IRQ_INTR
+
+/*
+ * Capture buffers are carved from a static DMA arena. The linker script must
+ * place ADAQ8092_DMA_ARENA_SECTION in DDR as a NOLOAD output section, e.g.
+ * .adaq8092_dma (NOLOAD) : ALIGN(32) { *(.adaq8092_dma) } > ps7_ddr_0
+ */
+#define ADAQ8092_DMA_ARENA_SECTION		".adaq8092_dma"
+#define ADAQ8092_DMA_ARENA_SIZE			(16 * 1024 * 1024)
+/* Cortex-A9 L1/L2 cache line size */
+#define ADAQ8092_DMA_ARENA_ALIGN		32
+/* Set to 1 if the HDL connects the DMAC master to the coherent S_AXI_ACP port */
+#define ADAQ8092_DMA_ACP			0
+
 #endif /* _PARAMETERS_H_ */
@@ -31,15 +31,39 @@
 # STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
 # THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+import json
+
 import numpy as np
 from adi.context_manager import context_manager
 from adi.rx_tx import rx
 
+# Largest AXI core gain correction, 32767 / 16384 in micro resolution
+CALIBSCALE_MAX = 1.999938
+
 # def _cast32(sample):
 #             sample = sample & 0xFFFFFF
 #             return (sample if not (sample & 0x800000) else sample - 0x1000000)
 
 
+def decode(data, alt_bit_pol=False, data_rand=False, twos_complement=True):
+    """Undo the output encoding applied by the ADAQ8092.
+
+    Only the low 14 bits of each word are used, so both raw and sign extended
+    words are accepted. Returns 14-bit two's complement samples sign extended
+    to int16.
+    """
+    val = np.asarray(data).astype(np.uint16) & np.uint16(0x3FFF)
+    # Alternate bit polarity is applied at the output buffers, after the
+    # randomizer, so it is undone first.
+    if alt_bit_pol:
+        val ^= np.uint16(0x2AAA)
+    if data_rand:
+        val ^= (val & np.uint16(1)) * np.uint16(0x3FFE)
+    if not twos_complement:
+        val ^= np.uint16(0x2000)
+    return (val << np.uint16(2)).view(np.int16) >> 2
+
+
 class adaq8092(rx, context_manager):
 
     """ADAQ8092 14-Bit, 105MSPS, Dual-Channel uModule Data Acquisition Solution"""
@@ -67,6 +91,196 @@ class adaq8092(rx, context_manager):
             self._rx_channel_names.append(name)
         rx.__init__(self)
 
+    rx_decode = False
+    """Decode randomized and alternate bit polarity data in software. Only
+    needed with FPGA designs that do not undo the encoding in the AXI core."""
+
+    rx_mark_reconfig = False
+    """Track reconfigurations across rx() calls, see rx_reconfigured."""
+
+    rx_reconfigured = False
+    """Set by rx() when rx_mark_reconfig is enabled and the device was
+    reconfigured while the returned block was captured, so the block may hold
+    samples taken with both the old and the new settings."""
+
+    _si_luts = None
+    _si_out = None
+    # reconfig_count seen at the end of the last rx() of the current buffer
+    _rx_reconfig_seen = None
+    # rx_decode mode and the reconfig_count it was read at
+    _rx_mode = None
+    _rx_mode_count = None
+
+    def rx(self):
+        """Receive data, decoding it for the current device mode if enabled.
+
+        With rx_output_type set to "SI" the samples are returned in volts,
+        see to_volts().
+        """
+        si = self.rx_output_type == "SI"
+        if si:
+            self.rx_output_type = "raw"
+        if self.rx_mark_reconfig:
+            # Queued blocks reach back to the previous call, not just this one
+            count = self._rx_reconfig_seen
+            if count is None:
+                count = self.reconfig_count
+        try:
+            data = rx.rx(self)
+        finally:
+            if si:
+                self.rx_output_type = "SI"
+        if self.rx_mark_reconfig or self.rx_decode:
+            # One read per call, the decode mode is only re-read on a change
+            seen = self.reconfig_count
+        if self.rx_mark_reconfig:
+            self._rx_reconfig_seen = seen
+            self.rx_reconfigured = seen != count
+        if self.rx_decode:
+            if self._rx_mode is None or self._rx_mode_count != seen:
+                self._rx_mode = (
+                    self.alt_bit_pol_en == "alternate_bit_polarity_on",
+                    self.data_rand_en == "data_randomizer_on",
+                )
+                self._rx_mode_count = seen
+            mode = self._rx_mode
+            if isinstance(data, list):
+                data = [decode(ch, *mode) for ch in data]
+            else:
+                data = decode(data, *mode)
+        if si:
+            return self.to_volts(data)
+        return data
+
+    def rx_destroy_buffer(self):
+        """Destroy the receive buffer, the next rx() starts a fresh capture."""
+        self._rx_reconfig_seen = None
+        rx.rx_destroy_buffer(self)
+
+    def _si_lut(self, name):
+        """Volts of every 16-bit word from the channel scale and offset.
+
+        Indexed by the whole word of the sign extended sample, as delivered by
+        the AXI core in either output format.
+        """
+        if self._si_luts is None:
+            self._si_luts = {}
+        if name not in self._si_luts:
+            scale = float(self._get_iio_attr_str(name, "scale", False)) / 1000
+            offset = int(self._get_iio_attr_str(name, "offset", False))
+            codes = np.arange(0x10000, dtype=np.uint16).view(np.int16)
+            codes = codes.astype(np.int32)
+            self._si_luts[name] = ((codes + offset) * scale).astype(np.float32)
+        return self._si_luts[name]
+
+    def to_volts(self, data, channels=None):
+        """Convert raw blocks of the enabled channels to float32 volts.
+
+        Each sample is looked up in a per channel table built from the IIO
+        scale and offset attributes, one vectorized pass per block. Results go
+        to arrays kept across calls, so they are overwritten by the next call;
+        copy them to keep a block. The tables are built once per channel, the
+        AXI core delivers two's complement in either output format.
+        """
+        if channels is None:
+            channels = self.rx_enabled_channels
+        single = not isinstance(data, list)
+        if single:
+            data = [data]
+        if self._si_out is None or [len(out) for out in self._si_out] != [
+            len(ch) for ch in data
+        ]:
+            self._si_out = [np.empty(len(ch), dtype=np.float32) for ch in data]
+        for raw, out, ch in zip(data, self._si_out, channels):
+            raw = np.asarray(raw, dtype=np.int16).view(np.uint16)
+            np.take(self._si_lut(self._rx_channel_names[ch]), raw, out=out)
+        return self._si_out[0] if single else self._si_out
+
+    def get_calibration(self):
+        """Offset and gain correction of every channel, applied by the AXI core."""
+        return {
+            name: {
+                "calibbias": int(self._get_iio_attr_str(name, "calibbias", False)),
+                "calibscale": float(self._get_iio_attr_str(name, "calibscale", False)),
+            }
+            for name in self._rx_channel_names
+        }
+
+    def set_calibration(self, cal):
+        """Program corrections as returned by get_calibration()."""
+        for name, values in cal.items():
+            self._set_iio_attr_str(name, "calibbias", False, str(values["calibbias"]))
+            self._set_iio_attr_str(
+                name, "calibscale", False, "%.6f" % values["calibscale"]
+            )
+
+    def save_calibration(self, path):
+        """Store the current corrections in a JSON file."""
+        with open(path, "w") as f:
+            json.dump(self.get_calibration(), f, indent=4)
+
+    def load_calibration(self, path):
+        """Program corrections stored by save_calibration()."""
+        with open(path) as f:
+            self.set_calibration(json.load(f))
+
+    def _calib_means(self, samples):
+        """Mean code of every channel over at least samples samples."""
+        enabled, output_type = self.rx_enabled_channels, self.rx_output_type
+        self.rx_destroy_buffer()
+        self.rx_enabled_channels = list(range(len(self._rx_channel_names)))
+        self.rx_output_type = "raw"
+        total = np.zeros(len(self._rx_channel_names))
+        count = 0
+        try:
+            while count < samples:
+                data = self.rx()
+                total += [np.sum(ch, dtype=np.int64) for ch in data]
+                count += len(data[0])
+        finally:
+            self.rx_destroy_buffer()
+            self.rx_enabled_channels = enabled
+            self.rx_output_type = output_type
+        return total / count
+
+    def calibrate_offset(self, samples=1 << 16):
+        """Null the offset of every channel, all inputs must be at 0 V."""
+        names = self._rx_channel_names
+        self.set_calibration(
+            {name: {"calibbias": 0, "calibscale": 1.0} for name in names}
+        )
+        means = self._calib_means(samples)
+        cal = {
+            name: {
+                "calibbias": int(np.clip(-np.round(mean), -8191, 8191)),
+                "calibscale": 1.0,
+            }
+            for name, mean in zip(names, means)
+        }
+        self.set_calibration(cal)
+        return cal
+
+    def calibrate_gain(self, volts, samples=1 << 16):
+        """Correct the gain of every channel, all inputs must be at volts.
+
+        Run after calibrate_offset() with a DC level close to full scale.
+        """
+        cal = self.get_calibration()
+        for name in cal:
+            cal[name]["calibscale"] = 1.0
+        self.set_calibration(cal)
+        means = self._calib_means(samples)
+        for name, mean in zip(cal, means):
+            scale = float(self._get_iio_attr_str(name, "scale", False)) / 1000
+            if not mean or volts / scale / mean <= 0:
+                raise ValueError("Error: no calibration signal on " + name)
+            # calibscale has micro resolution
+            cal[name]["calibscale"] = round(
+                float(np.clip(volts / scale / mean, 0, CALIBSCALE_MAX)), 6
+            )
+        self.set_calibration(cal)
+        return cal
+
     @property
     def alt_bit_pol_en_available(self):
         """Get available Alternate Bit Polarity Mode Control."""
@@ -82,6 +296,7 @@ class adaq8092(rx, context_manager):
         """Set Alternate Bit Polarity Mode Control."""
         if rate in self.alt_bit_pol_en_available:
             self._set_iio_dev_attr_str("alt_bit_pol_en", rate)
+            self._rx_mode = None
         else:
             raise ValueError(
                 "Error: Alternate Bit Polarity Mode Control not supported \nUse one of: "
@@ -166,6 +381,7 @@ class adaq8092(rx, context_manager):
         """Set Data Randomizer."""
         if rate in self.data_rand_en_available:
             self._set_iio_dev_attr_str("data_rand_en", rate)
+            self._rx_mode = None
         else:
             raise ValueError(
                 "Error: Data Randomizer not supported \nUse one of: "
@@ -214,6 +430,19 @@ class adaq8092(rx, context_manager):
                 + str(self.dout_mode_available)
             )
 
+    @property
+    def dout_switch_time_ns(self):
+        """Get the latency of the last Digital Output Mode switch."""
+        return self._get_iio_dev_attr("dout_switch_time_ns")
+
+    @property
+    def link_errors(self):
+        """Get the data link errors seen by the AXI core, per channel."""
+        return [
+            int(self._get_iio_attr_str(name, "link_errors", False))
+            for name in self._rx_channel_names
+        ]
+
     @property
     def lvds_cur_mode_available(self):
         """Get available LVDS Output Current."""
@@ -256,6 +485,14 @@ class adaq8092(rx, context_manager):
                 + str(self.lvds_term_mode_available)
             )
 
+    @property
+    def over_range_count(self):
+        """Get the input over-range excursions seen by the AXI core, per channel."""
+        return [
+            int(self._get_iio_attr_str(name, "over_range_count", False))
+            for name in self._rx_channel_names
+        ]
+
     @property
     def par_ser_gpio(self):
         """Get Paraller/Serial Gpio Value."""
@@ -303,6 +540,21 @@ class adaq8092(rx, context_manager):
                 + str(self.pd_mode_available)
             )
 
+    @property
+    def realign_count(self):
+        """Get the number of reconfigurations that realigned the data interface."""
+        return self._get_iio_dev_attr("realign_count")
+
+    @property
+    def realign_time_ns(self):
+        """Get the data downtime of the last realigning reconfiguration."""
+        return self._get_iio_dev_attr("realign_time_ns")
+
+    @property
+    def reconfig_count(self):
+        """Get the number of runtime reconfigurations."""
+        return self._get_iio_dev_attr("reconfig_count")
+
     @property
     def sampling_frequency(self):
         """Get Sampling Frequency."""
@@ -0,0 +1,209 @@
+# Copyright (C) 2022 Analog Devices, Inc.
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#     - Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     - Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in
+#       the documentation and/or other materials provided with the
+#       distribution.
+#     - Neither the name of Analog Devices, Inc. nor the names of its
+#       contributors may be used to endorse or promote products derived
+#       from this software without specific prior written permission.
+#     - The use of this software may or may not infringe the patent rights
+#       of one or more patent holders.  This license does not release you
+#       from the requirement that you obtain separate licenses from these
+#       patent holders to use this software.
+#     - Use of the software either in source or binary form, must be run
+#       on or directly connected to an Analog Devices Inc. component.
+#
+# THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+# INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+# PARTICULAR PURPOSE ARE DISCLAIMED.
+#
+# IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, INTELLECTUAL PROPERTY
+# RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+# BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+# STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+# THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+import numpy as np
+
+try:
+    import scipy.fft as _fft
+
+    _FFT_KWARGS = {"workers": -1}
+except ImportError:
+    _fft = np.fft
+    _FFT_KWARGS = {}
+
+# Cosine-sum window coefficients and main lobe half-width in bins
+_WINDOWS = {
+    "rectangular": ([1.0], 1),
+    "hann": ([0.5, 0.5], 2),
+    "blackman": ([0.42, 0.5, 0.08], 3),
+    "blackmanharris": ([0.35875, 0.48829, 0.14128, 0.01168], 4),
+    "flattop": ([0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368], 5),
+}
+
+
+class dynamic_analyzer:
+
+    """Streaming FFT based dynamic performance analyzer for ADAQ8092 data
+
+    Blocks returned by adaq8092.rx() are split into overlapping segments,
+    windowed and transformed, and their power spectra are averaged (Welch).
+    SNR, SINAD, SFDR, ENOB and THD are derived from the running average, so
+    results can be read after every block while capture continues.
+    """
+
+    _window_cache = {}
+
+    def __init__(
+        self,
+        fft_size=4096,
+        window="blackmanharris",
+        overlap=0.5,
+        sample_rate=105000000,
+        full_scale=2 ** 13,
+        harmonics=5,
+    ):
+        """Initialize."""
+        if window not in _WINDOWS:
+            raise ValueError(
+                "Error: Window not supported \nUse one of: " + str(list(_WINDOWS))
+            )
+        if not 0 <= overlap < 1:
+            raise ValueError("Error: overlap must be in [0, 1)")
+
+        self.fft_size = int(fft_size)
+        self.sample_rate = sample_rate
+        self.full_scale = full_scale
+        self.harmonics = harmonics
+        self._hop = max(1, int(round(self.fft_size * (1 - overlap))))
+        self._window, self._enbw, self._lobe = self._get_window(window, self.fft_size)
+        self._frames = None
+        self.reset()
+
+    @classmethod
+    def _get_window(cls, name, size):
+        """Return a cached (window, ENBW, lobe half-width) tuple."""
+        key = (name, size)
+        if key not in cls._window_cache:
+            coef, lobe = _WINDOWS[name]
+            n = np.arange(size)
+            win = np.zeros(size)
+            for k, a in enumerate(coef):
+                win += (-1) ** k * a * np.cos(2 * np.pi * k * n / size)
+            enbw = size * np.sum(win ** 2) / np.sum(win) ** 2
+            # Fold ENBW and the one-sided scaling into the window itself.
+            win = win * np.sqrt(2 / (enbw * np.sum(win) ** 2))
+            win.setflags(write=False)
+            cls._window_cache[key] = (win, enbw, lobe)
+        return cls._window_cache[key]
+
+    def reset(self):
+        """Discard the averaged spectra and any buffered samples."""
+        self._psd = None
+        self._tail = None
+        self.averages = 0
+
+    def update(self, data):
+        """Add a block of samples, one row per channel, to the running average."""
+        data = np.atleast_2d(np.asarray(data, dtype=np.float64))
+        if self._tail is not None:
+            data = np.concatenate((self._tail, data), axis=1)
+
+        count = 0
+        if data.shape[1] >= self.fft_size:
+            count = (data.shape[1] - self.fft_size) // self._hop + 1
+            frames = np.lib.stride_tricks.sliding_window_view(
+                data, self.fft_size, axis=1
+            )[:, : count * self._hop : self._hop]
+            if self._frames is None or self._frames.shape != frames.shape:
+                self._frames = np.empty(frames.shape)
+            np.multiply(frames, self._window, out=self._frames)
+
+            spec = _fft.rfft(self._frames, axis=-1, **_FFT_KWARGS)
+            power = np.sum(spec.real ** 2 + spec.imag ** 2, axis=1)
+            if self._psd is None:
+                self._psd = power
+            else:
+                self._psd += power
+            self.averages += count
+
+        self._tail = data[:, count * self._hop :]
+
+    def spectrum(self):
+        """Return the averaged one-sided power spectrum in dBFS, per channel."""
+        if self._psd is None:
+            raise RuntimeError("Error: no complete segment received yet")
+        psd = self._psd / self.averages
+        return 10 * np.log10(psd / (self.full_scale ** 2 / 2) + 1e-30)
+
+    def _bin_power(self, psd, center):
+        lo = max(center - self._lobe, 0)
+        return np.sum(psd[lo : center + self._lobe + 1]), lo, center + self._lobe + 1
+
+    def _fold(self, freq_bin):
+        freq_bin %= self.fft_size
+        return self.fft_size - freq_bin if freq_bin > self.fft_size // 2 else freq_bin
+
+    def _channel_metrics(self, psd):
+        used = np.zeros(psd.size, dtype=bool)
+        used[: self._lobe + 1] = True
+
+        search = psd.copy()
+        search[used] = 0
+        fund = int(np.argmax(search))
+        signal, lo, hi = self._bin_power(psd, fund)
+        used[lo:hi] = True
+
+        distortion = 0.0
+        for h in range(2, self.harmonics + 1):
+            center = self._fold(h * fund)
+            if used[center]:
+                continue
+            power, lo, hi = self._bin_power(psd, center)
+            distortion += power
+            used[lo:hi] = True
+
+        noise = np.sum(psd[~used])
+        # Spread the noise floor over the excluded bins as well.
+        noise *= psd.size / max(np.count_nonzero(~used), 1)
+
+        spur = psd.copy()
+        lo = max(fund - self._lobe, 0)
+        spur[lo : fund + self._lobe + 1] = 0
+        spur[: self._lobe + 1] = 0
+
+        sinad = 10 * np.log10(signal / (noise + distortion))
+        return {
+            "frequency": float(fund * self.sample_rate / self.fft_size),
+            "amplitude_dbfs": float(
+                10 * np.log10(signal / (self.full_scale ** 2 / 2))
+            ),
+            "snr": float(10 * np.log10(signal / noise)),
+            "sinad": float(sinad),
+            "thd": float(10 * np.log10(max(distortion, 1e-30) / signal)),
+            "sfdr": float(10 * np.log10(psd[fund] / max(np.max(spur), 1e-30))),
+            "enob": float((sinad - 1.76) / 6.02),
+        }
+
+    def metrics(self):
+        """Return a list with SNR/SINAD/SFDR/ENOB/THD dictionaries per channel."""
+        if self._psd is None:
+            raise RuntimeError("Error: no complete segment received yet")
+        psd = self._psd / self.averages
+        return [self._channel_metrics(ch) for ch in psd]
+
+    def run(self, dev, blocks):
+        """Capture blocks from an adaq8092 instance, yielding updated metrics."""
+        for _ in range(blocks):
+            self.update(dev.rx())
+            if self.averages:
+                yield self.metrics()
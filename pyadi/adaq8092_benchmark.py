@@ -0,0 +1,222 @@
+# Copyright (C) 2022 Analog Devices, Inc.
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#     - Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     - Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in
+#       the documentation and/or other materials provided with the
+#       distribution.
+#     - Neither the name of Analog Devices, Inc. nor the names of its
+#       contributors may be used to endorse or promote products derived
+#       from this software without specific prior written permission.
+#     - The use of this software may or may not infringe the patent rights
+#       of one or more patent holders.  This license does not release you
+#       from the requirement that you obtain separate licenses from these
+#       patent holders to use this software.
+#     - Use of the software either in source or binary form, must be run
+#       on or directly connected to an Analog Devices Inc. component.
+#
+# THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+# INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+# PARTICULAR PURPOSE ARE DISCLAIMED.
+#
+# IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, INTELLECTUAL PROPERTY
+# RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+# BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+# STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+# THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Throughput and latency benchmarks of the pyadi capture path
+
+Runs against a real board or, without a URI, against the local emulator:
+
+    python3 adaq8092_benchmark.py --uri ip:analog.local --json results.json
+    python3 adaq8092_benchmark.py --thresholds adaq8092_benchmark.json
+
+Every result is a flat "group/name" metric. A thresholds file maps metrics to
+{"min": x} or {"max": x}; any metric outside its limits is reported and the
+script exits with status 1, so it can guard against regressions.
+"""
+
+import argparse
+import json
+import platform
+import sys
+import time
+
+import numpy as np
+
+ATTRS = [
+    "alt_bit_pol_en",
+    "clk_dc_mode",
+    "clk_phase_mode",
+    "clk_pol_mode",
+    "data_rand_en",
+    "dout_en",
+    "lvds_cur_mode",
+    "lvds_term_mode",
+    "test_mode",
+    "twos_complement",
+]
+
+BUFFER_SIZES = [1 << n for n in range(10, 21, 2)]
+
+
+def _best(func, repeat):
+    """Smallest and median run time of func in seconds."""
+    times = []
+    for _ in range(repeat):
+        start = time.perf_counter()
+        func()
+        times.append(time.perf_counter() - start)
+    return min(times), float(np.median(times))
+
+
+def bench_rx(dev, sizes=BUFFER_SIZES, repeat=10):
+    """Sustained rx() rate for every buffer size."""
+    results = {}
+    num_ch = len(dev.rx_enabled_channels)
+    for size in sizes:
+        dev.rx_destroy_buffer()
+        dev.rx_buffer_size = size
+        dev.rx()
+        start = time.perf_counter()
+        for _ in range(repeat):
+            dev.rx()
+        elapsed = (time.perf_counter() - start) / repeat
+        results["rx_msps/%d" % size] = size / elapsed / 1e6
+        results["rx_mbps/%d" % size] = size * num_ch * 2 / elapsed / 1e6
+    dev.rx_destroy_buffer()
+    return results
+
+
+def bench_attrs(dev, attrs=ATTRS, repeat=20):
+    """Median get and set latency of every attribute in microseconds."""
+    results = {}
+    for attr in attrs:
+        value = getattr(dev, attr)
+        results["attr_get_us/" + attr] = (
+            _best(lambda: getattr(dev, attr), repeat)[1] * 1e6
+        )
+        results["attr_set_us/" + attr] = (
+            _best(lambda: setattr(dev, attr, value), repeat)[1] * 1e6
+        )
+    return results
+
+
+def bench_deinterleave(sizes=BUFFER_SIZES, num_ch=2, repeat=20):
+    """Cost of splitting an interleaved int16 buffer into channel arrays."""
+    results = {}
+    for size in sizes:
+        raw = np.zeros(size * num_ch, dtype=np.int16).tobytes()
+
+        def split():
+            data = np.frombuffer(raw, dtype=np.int16)
+            return [data[ch::num_ch].copy() for ch in range(num_ch)]
+
+        best = _best(split, repeat)[0]
+        results["deinterleave_ns_per_sample/%d" % size] = best / size * 1e9
+    return results
+
+
+def bench_latency(dev, size=1 << 12, repeat=50):
+    """Time from a buffer refill to the returned numpy arrays.
+
+    Splits the path into the refill and the copy out of the libiio buffer
+    when the pyadi internals allow it.
+    """
+    dev.rx_destroy_buffer()
+    dev.rx_buffer_size = size
+    dev.rx()
+    results = {"latency_us/rx": _best(dev.rx, repeat)[1] * 1e6}
+    rxbuf = getattr(dev, "_rxbuf", None)
+    if rxbuf is not None:
+        results["latency_us/refill"] = _best(rxbuf.refill, repeat)[1] * 1e6
+        results["latency_us/read"] = _best(rxbuf.read, repeat)[1] * 1e6
+    dev.rx_destroy_buffer()
+    return results
+
+
+def check_thresholds(results, thresholds):
+    """List of messages for every metric outside its limits."""
+    failures = []
+    for name, limit in sorted(thresholds.items()):
+        if name not in results:
+            failures.append("%s: not measured" % name)
+            continue
+        value = results[name]
+        if "min" in limit and value < limit["min"]:
+            failures.append("%s: %.3f below %.3f" % (name, value, limit["min"]))
+        if "max" in limit and value > limit["max"]:
+            failures.append("%s: %.3f above %.3f" % (name, value, limit["max"]))
+    return failures
+
+
+def run(uri, sizes=BUFFER_SIZES, repeat=10):
+    """Run every benchmark against uri and return the metrics."""
+    from adi import adaq8092
+
+    dev = adaq8092(uri=uri)
+    dev.rx_enabled_channels = [0, 1]
+    dev.rx_output_type = "raw"
+    results = {}
+    results.update(bench_rx(dev, sizes, repeat))
+    results.update(bench_attrs(dev))
+    results.update(bench_deinterleave(sizes))
+    results.update(bench_latency(dev))
+    del dev
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--uri", help="context to measure, emulated if unset")
+    parser.add_argument("--json", help="write the results to this file")
+    parser.add_argument("--thresholds", help="JSON file with regression limits")
+    parser.add_argument("--repeat", type=int, default=10)
+    parser.add_argument(
+        "--max-size", type=int, default=BUFFER_SIZES[-1], help="largest buffer"
+    )
+    args = parser.parse_args()
+
+    sizes = [size for size in BUFFER_SIZES if size <= args.max_size]
+    if args.uri:
+        results = run(args.uri, sizes, args.repeat)
+    else:
+        from adi.adaq8092_emu import adaq8092_emu
+
+        with adaq8092_emu() as emu:
+            results = run(emu.uri, sizes, args.repeat)
+
+    for name, value in results.items():
+        print("{:<44}{:>14.3f}".format(name, value))
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(
+                {
+                    "uri": args.uri or "emulated",
+                    "host": platform.node(),
+                    "python": platform.python_version(),
+                    "results": results,
+                },
+                f,
+                indent=4,
+            )
+
+    if args.thresholds:
+        with open(args.thresholds) as f:
+            failures = check_thresholds(results, json.load(f))
+        for failure in failures:
+            print("REGRESSION " + failure)
+        if failures:
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,508 @@
+# Copyright (C) 2022 Analog Devices, Inc.
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#     - Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     - Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in
+#       the documentation and/or other materials provided with the
+#       distribution.
+#     - Neither the name of Analog Devices, Inc. nor the names of its
+#       contributors may be used to endorse or promote products derived
+#       from this software without specific prior written permission.
+#     - The use of this software may or may not infringe the patent rights
+#       of one or more patent holders.  This license does not release you
+#       from the requirement that you obtain separate licenses from these
+#       patent holders to use this software.
+#     - Use of the software either in source or binary form, must be run
+#       on or directly connected to an Analog Devices Inc. component.
+#
+# THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+# INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+# PARTICULAR PURPOSE ARE DISCLAIMED.
+#
+# IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, INTELLECTUAL PROPERTY
+# RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+# BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+# STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+# THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Emulated ADAQ8092 IIO context
+
+Serves an adaq8092 device over the iiod ASCII protocol on a local TCP socket,
+so pyadi and the tests run without hardware:
+
+    python3 adaq8092_emu.py --port 30431 --signal sine
+    pytest --uri=ip:127.0.0.1 test_adaq8092.py
+
+The device mirrors the Linux driver: the shared ext_info attributes as device
+attributes and two 14-bit channels. Streams are a sine, noise or a ramp,
+replaced by the selected pattern when test_mode is set, and can be throttled
+to a fixed sample rate to model the capture bandwidth.
+"""
+
+import argparse
+import errno
+import socketserver
+import threading
+import time
+from xml.sax.saxutils import quoteattr
+
+import numpy as np
+
+_VERSION = "0.25.emulate\n"
+
+_NUM_CH = 2
+
+# Full-scale input span, peak-to-peak
+_INPUT_RANGE_MV = 2000
+
+# Largest gain correction of the AXI core, 32767 / 16384 in micro resolution
+_CALIBSCALE_MAX = 1.999938
+
+_ENUMS = {
+    "pd_mode": ["normal", "ch2_nap", "ch1_ch2_nap", "sleep"],
+    "clk_pol_mode": ["clk_pol_normal", "clk_pol_inverted"],
+    "clk_phase_mode": [
+        "clk_phase_no_delay",
+        "clk_phase_45deg",
+        "clk_phase_90deg",
+        "clk_phase_180deg",
+    ],
+    "clk_dc_mode": ["clk_dc_stabilizer_off", "clk_dc_stabilizer_on"],
+    "lvds_cur_mode": [
+        "lvds_current_3m5A",
+        "lvds_current_4mA",
+        "lvds_current_4m5A",
+        "lvds_current_3mA",
+        "lvds_current_2m5A",
+        "lvds_current_3m1A",
+        "lvds_current_1m75A",
+    ],
+    "lvds_term_mode": ["lvds_internal_termination_off", "lvds_internal_termination_on"],
+    "dout_en": ["digital_output_on", "digital_output_off"],
+    "dout_mode": [
+        "full_rate_cmos_output",
+        "double_data_rate_lvds_output",
+        "double_data_rate_cmos_output",
+    ],
+    "test_mode": [
+        "test_pattern_off",
+        "test_all_digital_zero",
+        "test_all_digital_one",
+        "test_checkerboard",
+        "test_alternating",
+    ],
+    "alt_bit_pol_en": ["alternate_bit_polarity_off", "alternate_bit_polarity_on"],
+    "data_rand_en": ["data_randomizer_off", "data_randomizer_on"],
+    "twos_complement": ["offset_binary", "twos_complement"],
+    "pd_gpio": ["pd1_on_pd2_on", "pd1_off_pd2_on", "pd1_on_pd2_off", "pd1_off_pd2_off"],
+}
+
+_DEFAULTS = {
+    "clk_dc_mode": "clk_dc_stabilizer_on",
+    "dout_mode": "double_data_rate_lvds_output",
+    "twos_complement": "twos_complement",
+}
+
+# Read only attributes and their initial values
+_STATUS = {
+    "par_ser_gpio": "parallel_mode",
+    "spi_clk_freq": "25000000",
+    "reconfig_count": "0",
+    "realign_count": "0",
+    "realign_time_ns": "0",
+    "dout_switch_time_ns": "0",
+    "reset_time_ns": "0",
+}
+
+# Settings the driver applies with the data interface held in reset
+_REALIGN = {
+    "clk_pol_mode",
+    "clk_phase_mode",
+    "clk_dc_mode",
+    "dout_mode",
+    "alt_bit_pol_en",
+    "data_rand_en",
+}
+
+# 14-bit output words of the digital test patterns, two samples per period.
+# OUTTEST 001 drives every output low and 011 every output high.
+_PATTERNS = {
+    "test_all_digital_zero": (0x0000, 0x0000),
+    "test_all_digital_one": (0x3FFF, 0x3FFF),
+    "test_checkerboard": (0x2AAA, 0x1555),
+    "test_alternating": (0x0000, 0x3FFF),
+}
+
+SIGNALS = ["sine", "noise", "ramp"]
+
+
+def _sign_extend(raw):
+    return ((raw.astype(np.int32) ^ 0x2000) - 0x2000).astype(np.int16)
+
+
+class emulated_adaq8092:
+
+    """State and sample generator of one emulated device"""
+
+    def __init__(
+        self,
+        signal="sine",
+        frequency=1e6,
+        amplitude=4000,
+        noise=3.0,
+        rate=None,
+        encode=False,
+        offset_error=0.0,
+        gain_error=1.0,
+        seed=None,
+    ):
+        if signal not in SIGNALS:
+            raise ValueError(
+                "Error: signal not supported \nUse one of: " + str(SIGNALS)
+            )
+        self.signal = signal
+        self.frequency = frequency
+        self.amplitude = amplitude
+        self.noise = noise
+        self.rate = rate
+        self.encode = encode
+        self.offset_error = offset_error
+        self.gain_error = gain_error
+        self.calibbias = [0] * _NUM_CH
+        self.calibscale = [1.0] * _NUM_CH
+        self.link_errors = [0] * _NUM_CH
+        self.over_range = np.zeros(_NUM_CH, dtype=np.int64)
+        self._over = np.zeros(_NUM_CH, dtype=bool)
+        self.attrs = {
+            name: _DEFAULTS.get(name, items[0]) for name, items in _ENUMS.items()
+        }
+        self.attrs.update(_STATUS)
+        self.attrs["sampling_frequency"] = "105000000"
+        self.lock = threading.Lock()
+        self._rng = np.random.default_rng(seed)
+        self._pos = 0
+        self._start = None
+
+    def xml(self):
+        """Context description in the format of the iiod PRINT command."""
+        attrs = sorted(self.attrs) + [name + "_available" for name in sorted(_ENUMS)]
+        channels = "".join(
+            '<channel id="voltage{0}" name="channel{0}" type="input">'
+            '<scan-element index="{0}" format="le:s14/16&gt;&gt;0" />'
+            '<attribute name="calibbias" filename="in_voltage{0}_calibbias" />'
+            '<attribute name="calibscale" filename="in_voltage{0}_calibscale" />'
+            '<attribute name="link_errors" filename="in_voltage{0}_link_errors" />'
+            '<attribute name="offset" filename="in_voltage{0}_offset" />'
+            '<attribute name="over_range_count" '
+            'filename="in_voltage{0}_over_range_count" />'
+            '<attribute name="scale" filename="in_voltage{0}_scale" />'
+            "</channel>".format(ch)
+            for ch in range(_NUM_CH)
+        )
+        return (
+            '<?xml version="1.0" encoding="utf-8"?>'
+            '<context name="network" description="ADAQ8092 emulator">'
+            '<context-attribute name="hw_model" value="ADAQ8092 emulator" />'
+            '<device id="iio:device0" name="adaq8092">'
+            + channels
+            + "".join("<attribute name=%s />" % quoteattr(name) for name in attrs)
+            + "</device></context>"
+        )
+
+    def read_attr(self, name):
+        """Read a device attribute, returns the value or a negative errno."""
+        if name.endswith("_available") and name[: -len("_available")] in _ENUMS:
+            return " ".join(_ENUMS[name[: -len("_available")]])
+        with self.lock:
+            return self.attrs.get(name, -errno.ENOENT)
+
+    def read_chan_attr(self, ch, name):
+        """Read a channel attribute, returns the value or a negative errno."""
+        if name == "calibbias":
+            return str(self.calibbias[ch])
+        if name == "calibscale":
+            return "%.6f" % self.calibscale[ch]
+        if name == "link_errors":
+            with self.lock:
+                return str(self.link_errors[ch])
+        if name == "over_range_count":
+            with self.lock:
+                return str(self.over_range[ch])
+        if name == "scale":
+            return "%.9f" % (_INPUT_RANGE_MV / 0x4000)
+        if name == "offset":
+            # The core converts offset binary back to two's complement
+            return "0"
+        return -errno.ENOENT
+
+    def write_chan_attr(self, ch, name, value):
+        """Write a channel attribute, returns 0 or a negative errno."""
+        try:
+            value = float(value)
+        except ValueError:
+            return -errno.EINVAL
+        with self.lock:
+            if name == "calibbias" and abs(value) <= 8191:
+                self.calibbias[ch] = int(value)
+            elif name == "calibscale" and 0 <= value <= _CALIBSCALE_MAX:
+                self.calibscale[ch] = value
+            elif name in ("calibbias", "calibscale"):
+                return -errno.EINVAL
+            elif name in ("scale", "offset", "link_errors", "over_range_count"):
+                return -errno.EACCES
+            else:
+                return -errno.ENOENT
+            self._count("reconfig_count")
+        return 0
+
+    def write_attr(self, name, value):
+        """Write a device attribute, returns 0 or a negative errno."""
+        value = value.strip()
+        with self.lock:
+            if name == "sampling_frequency":
+                try:
+                    int(value)
+                except ValueError:
+                    return -errno.EINVAL
+            elif name in _ENUMS:
+                if value not in _ENUMS[name]:
+                    return -errno.EINVAL
+                self._count("reconfig_count")
+                if name in _REALIGN:
+                    self._count("realign_count")
+            elif name in self.attrs:
+                return -errno.EACCES
+            else:
+                return -errno.ENOENT
+            self.attrs[name] = value
+        return 0
+
+    def _count(self, name):
+        self.attrs[name] = str(int(self.attrs[name]) + 1)
+
+    def _codes(self, count):
+        """Next count samples of both channels as 14-bit two's complement."""
+        t = np.arange(self._pos, self._pos + count)
+        if self.signal == "sine":
+            fs = int(self.attrs["sampling_frequency"])
+            phase = 2 * np.pi * self.frequency / fs * t
+            data = self.amplitude * np.stack([np.sin(phase), np.cos(phase)])
+        elif self.signal == "noise":
+            data = np.zeros((_NUM_CH, count))
+        else:
+            data = np.stack([t, -t]) % 0x4000 - 0x2000
+        if self.noise:
+            data = data + self.noise * self._rng.standard_normal(data.shape)
+        # Front end error, then the AXI core offset and gain correction
+        data = data * self.gain_error + self.offset_error
+        data = (data + np.c_[self.calibbias]) * np.c_[self.calibscale]
+        data = np.clip(np.round(data), -0x2000, 0x1FFF)
+        # Sticky over-range flag of the core, one count per saturated stretch
+        over = (data == -0x2000) | (data == 0x1FFF)
+        if count:
+            self.over_range += (over & ~np.c_[self._over, over[:, :-1]]).sum(axis=1)
+            self._over = over[:, -1]
+        return data.astype(np.int16)
+
+    def samples(self, count):
+        """Next count samples of both channels as output by the AXI core."""
+        with self.lock:
+            test = self.attrs["test_mode"]
+            if test in _PATTERNS:
+                pattern = np.roll(np.array(_PATTERNS[test], np.uint16), self._pos % 2)
+                raw = np.tile(np.resize(pattern, count), (_NUM_CH, 1))
+            else:
+                # Offset binary is undone by the core, so it never shows here
+                raw = self._codes(count).astype(np.uint16) & np.uint16(0x3FFF)
+                if self.encode and self.attrs["data_rand_en"].endswith("_on"):
+                    raw ^= (raw & np.uint16(1)) * np.uint16(0x3FFE)
+                if self.encode and self.attrs["alt_bit_pol_en"].endswith("_on"):
+                    raw ^= np.uint16(0x2AAA)
+            self._pos += count
+        return _sign_extend(raw)
+
+    def throttle(self, count):
+        """Hold the caller back so the stream does not exceed rate."""
+        if not self.rate:
+            return
+        now = time.perf_counter()
+        if self._start is None:
+            self._start = now - self._pos / self.rate
+        delay = self._start + (self._pos + count) / self.rate - now
+        if delay > 0:
+            time.sleep(delay)
+
+
+class _iiod_handler(socketserver.StreamRequestHandler):
+
+    """One client connection, commands as sent by the libiio network backend"""
+
+    def setup(self):
+        super().setup()
+        self.mask = 0
+
+    def _reply(self, value, data=None):
+        out = b"%d\n" % value
+        if data is not None:
+            out += data
+        self.wfile.write(out)
+
+    def handle(self):
+        dev = self.server.device
+        for line in self.rfile:
+            args = line.decode("ascii", "replace").split()
+            if not args:
+                continue
+            cmd = args[0].upper()
+            if cmd == "EXIT":
+                break
+            if cmd == "VERSION":
+                self.wfile.write(_VERSION.encode())
+            elif cmd == "PRINT":
+                xml = dev.xml().encode()
+                self._reply(len(xml), xml + b"\n")
+            elif cmd in ("TIMEOUT", "CLOSE", "SET"):
+                self._reply(0)
+            elif cmd == "OPEN" and len(args) >= 4:
+                self.mask = int(args[3], 16)
+                self._reply(0)
+            elif cmd == "READ" and len(args) in (3, 5):
+                if len(args) == 3:
+                    value = dev.read_attr(args[2])
+                elif args[2] == "INPUT" and args[3] in self.server.channels:
+                    ch = self.server.channels.index(args[3])
+                    value = dev.read_chan_attr(ch, args[4])
+                else:
+                    value = -errno.ENODEV
+                if isinstance(value, int):
+                    self._reply(value)
+                else:
+                    value = value.encode()
+                    self._reply(len(value), value + b"\n")
+            elif cmd == "WRITE" and len(args) == 4:
+                value = self.rfile.read(int(args[3]))
+                self._reply(dev.write_attr(args[2], value.decode()) or len(value))
+            elif (
+                cmd == "WRITE"
+                and len(args) == 6
+                and args[2] == "INPUT"
+                and args[3] in self.server.channels
+            ):
+                value = self.rfile.read(int(args[5]))
+                ch = self.server.channels.index(args[3])
+                ret = dev.write_chan_attr(ch, args[4], value.decode())
+                self._reply(ret or len(value))
+            elif cmd == "READBUF" and len(args) == 3:
+                self._readbuf(dev, int(args[2]))
+            elif cmd in ("READ", "WRITE", "GETTRIG"):
+                # Debug and buffer attributes and triggers are not emulated,
+                # drop the value so the stream stays in sync
+                if cmd == "WRITE":
+                    self.rfile.read(int(args[-1]))
+                self._reply(-errno.ENOENT)
+            else:
+                self._reply(-errno.EINVAL)
+            self.wfile.flush()
+
+    def _readbuf(self, dev, size):
+        enabled = [ch for ch in range(_NUM_CH) if self.mask & (1 << ch)]
+        if not enabled:
+            self._reply(-errno.EINVAL)
+            return
+        count = size // (2 * len(enabled))
+        dev.throttle(count)
+        data = dev.samples(count)[enabled].T.astype("<i2").tobytes()
+        self._reply(len(data), b"%08x\n" % self.mask + data)
+
+
+class _iiod_server(socketserver.ThreadingTCPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+
+
+class adaq8092_emu:
+
+    """Local iiod server for one emulated ADAQ8092
+
+    Use as a context manager, uri then holds the URI to pass to pyadi. Port 0
+    picks a free port; libiio only connects to a non default port with a
+    host:port URI.
+    """
+
+    def __init__(self, host="127.0.0.1", port=0, **kwargs):
+        self.device = emulated_adaq8092(**kwargs)
+        self._server = _iiod_server((host, port), _iiod_handler)
+        self._server.device = self.device
+        self._server.channels = ["voltage%d" % ch for ch in range(_NUM_CH)]
+        self._thread = None
+
+    @property
+    def address(self):
+        return self._server.server_address
+
+    @property
+    def uri(self):
+        host, port = self.address
+        return "ip:%s" % host if port == 30431 else "ip:%s:%d" % (host, port)
+
+    def start(self):
+        """Serve clients from a background thread."""
+        self._thread = threading.Thread(target=self._server.serve_forever, daemon=True)
+        self._thread.start()
+        return self
+
+    def stop(self):
+        """Stop serving and close the socket."""
+        if self._thread:
+            self._server.shutdown()
+            self._thread.join()
+            self._thread = None
+        self._server.server_close()
+
+    def __enter__(self):
+        return self.start()
+
+    def __exit__(self, *args):
+        self.stop()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Emulated ADAQ8092 IIO context")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=30431)
+    parser.add_argument("--signal", choices=SIGNALS, default="sine")
+    parser.add_argument("--frequency", type=float, default=1e6, help="tone in Hz")
+    parser.add_argument("--amplitude", type=float, default=4000, help="tone in codes")
+    parser.add_argument("--noise", type=float, default=3.0, help="rms in codes")
+    parser.add_argument(
+        "--offset-error", type=float, default=0.0, help="front end offset in codes"
+    )
+    parser.add_argument(
+        "--gain-error", type=float, default=1.0, help="front end gain factor"
+    )
+    parser.add_argument(
+        "--rate", type=float, help="samples per second, unlimited if unset"
+    )
+    parser.add_argument(
+        "--encode",
+        action="store_true",
+        help="keep the randomizer and alternate bit polarity encoding in the stream",
+    )
+    args = vars(parser.parse_args())
+    emu = adaq8092_emu(**args)
+    print("serving " + emu.uri, flush=True)
+    try:
+        emu._server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    emu.stop()
+
+
+if __name__ == "__main__":
+    main()
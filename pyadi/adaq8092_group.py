@@ -0,0 +1,166 @@
+# Copyright (C) 2022 Analog Devices, Inc.
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#     - Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     - Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in
+#       the documentation and/or other materials provided with the
+#       distribution.
+#     - Neither the name of Analog Devices, Inc. nor the names of its
+#       contributors may be used to endorse or promote products derived
+#       from this software without specific prior written permission.
+#     - The use of this software may or may not infringe the patent rights
+#       of one or more patent holders.  This license does not release you
+#       from the requirement that you obtain separate licenses from these
+#       patent holders to use this software.
+#     - Use of the software either in source or binary form, must be run
+#       on or directly connected to an Analog Devices Inc. component.
+#
+# THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+# INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+# PARTICULAR PURPOSE ARE DISCLAIMED.
+#
+# IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, INTELLECTUAL PROPERTY
+# RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+# BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+# STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+# THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Parallel capture from several ADAQ8092 contexts
+
+Every board is driven from its own worker thread, so buffer refills overlap
+instead of adding up. libiio drops the GIL while it waits on a refill, so the
+threads run concurrently even for network contexts.
+"""
+
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+from adi.adaq8092 import adaq8092
+from adi.adaq8092_sync import align, merge
+
+
+def _channels(data):
+    """rx() returns a bare array when only one channel is enabled."""
+    return data if isinstance(data, list) else [data]
+
+
+class adaq8092_group:
+
+    """Group of ADAQ8092 devices captured in parallel
+
+    rx() returns one stacked array, rows are the channels of the first board
+    followed by those of the second board and so on. With ref_ch set to a
+    channel number, the boards are aligned on a shared rising edge of that
+    channel, which must be enabled, see adi.adaq8092_sync; offsets then holds
+    the sample offset of every board.
+    """
+
+    def __init__(self, uris, ref_ch=None, threshold=0, device=adaq8092):
+        """Open all contexts in parallel."""
+        if not uris:
+            raise ValueError("Error: no URI given")
+        self.uris = list(uris)
+        self.ref_ch = ref_ch
+        self.threshold = threshold
+        self.offsets = [0] * len(self.uris)
+        self._pool = ThreadPoolExecutor(max_workers=len(self.uris))
+        self.devices = list(self._pool.map(device, self.uris))
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def __len__(self):
+        return len(self.devices)
+
+    def close(self):
+        """Stop the worker threads and release all contexts."""
+        self._pool.shutdown()
+        for dev in self.devices:
+            if hasattr(dev, "rx_destroy_buffer"):
+                dev.rx_destroy_buffer()
+        self.devices = []
+
+    def _each(self, func):
+        return list(self._pool.map(func, self.devices))
+
+    def set_attr(self, attr, val):
+        """Set the same attribute on every device."""
+        self._each(lambda dev: setattr(dev, attr, val))
+
+    def get_attr(self, attr):
+        """Read an attribute from every device."""
+        return self._each(lambda dev: getattr(dev, attr))
+
+    @property
+    def rx_buffer_size(self):
+        """Get the buffer size of the first device."""
+        return self.devices[0].rx_buffer_size
+
+    @rx_buffer_size.setter
+    def rx_buffer_size(self, size):
+        """Set the buffer size of every device."""
+        self.set_attr("rx_buffer_size", size)
+
+    def rx_raw(self):
+        """Capture one buffer per device, returns a list of channel lists."""
+        return self._each(lambda dev: _channels(dev.rx()))
+
+    def rx(self):
+        """Capture all devices in parallel and return the stacked channels."""
+        if self.ref_ch is not None:
+            # rx() only returns the enabled channels
+            enabled = list(self.devices[0].rx_enabled_channels)
+            if self.ref_ch not in enabled:
+                raise ValueError(
+                    "Error: reference channel %d is not enabled" % self.ref_ch
+                )
+        captures = self.rx_raw()
+        if self.ref_ch is None:
+            return merge(captures, self.offsets)
+        merged, self.offsets = align(
+            captures, enabled.index(self.ref_ch), self.threshold
+        )
+        return merged
+
+
+def benchmark(uris, rx_buffer_size=1 << 16, repeat=5, device=adaq8092):
+    """Measure capture time for groups of 1 to len(uris) devices.
+
+    Every group size is captured serially, one device after the other, and
+    in parallel through adaq8092_group. Returns a list with one dict per group
+    size holding the best times in seconds and the parallel rate in MB/s.
+    """
+    results = []
+    for num in range(1, len(uris) + 1):
+        with adaq8092_group(uris[:num], device=device) as group:
+            group.rx_buffer_size = rx_buffer_size
+            data = group.rx()
+            serial = parallel = float("inf")
+            for _ in range(repeat):
+                start = time.perf_counter()
+                for dev in group.devices:
+                    dev.rx()
+                serial = min(serial, time.perf_counter() - start)
+                start = time.perf_counter()
+                group.rx()
+                parallel = min(parallel, time.perf_counter() - start)
+        results.append(
+            {
+                "devices": num,
+                "serial_s": serial,
+                "parallel_s": parallel,
+                "speedup": serial / parallel,
+                "parallel_mbps": data.nbytes / 1e6 / parallel,
+            }
+        )
+    return results
@@ -0,0 +1,250 @@
+# Copyright (C) 2022 Analog Devices, Inc.
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#     - Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     - Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in
+#       the documentation and/or other materials provided with the
+#       distribution.
+#     - Neither the name of Analog Devices, Inc. nor the names of its
+#       contributors may be used to endorse or promote products derived
+#       from this software without specific prior written permission.
+#     - The use of this software may or may not infringe the patent rights
+#       of one or more patent holders.  This license does not release you
+#       from the requirement that you obtain separate licenses from these
+#       patent holders to use this software.
+#     - Use of the software either in source or binary form, must be run
+#       on or directly connected to an Analog Devices Inc. component.
+#
+# THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+# INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+# PARTICULAR PURPOSE ARE DISCLAIMED.
+#
+# IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, INTELLECTUAL PROPERTY
+# RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+# BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+# STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+# THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+import struct
+import time
+
+import numpy as np
+
+# Four 14-bit samples are stored as one little endian 56-bit word
+_GROUP = 4
+_GROUP_BYTES = 7
+
+# Delta codec: one width byte followed by 64 values of width bits each
+_DELTA_BLOCK = 64
+_DELTA_MAX_WIDTH = 14
+
+# Container header, matches noos/adaq8092_pack.h
+_MAGIC = 0x4B503841
+_VERSION = 1
+_HDR = struct.Struct("<IBBBBII")
+
+FORMATS = {"raw16": 0, "packed14": 1, "delta": 2}
+
+_MASK = 0x3FFF
+_SIGN = 0x2000
+
+
+def _sign_extend(values):
+    return ((values.astype(np.int32) ^ _SIGN) - _SIGN).astype(np.int16)
+
+
+def pack14(data):
+    """Pack 14-bit samples, four samples into seven bytes.
+
+    The upper two bits of each sample are ignored, the last group is zero
+    padded. Returns a uint8 array of ceil(len / 4) * 7 bytes.
+    """
+    data = np.asarray(data).ravel()
+    groups = -(-data.size // _GROUP)
+    x = np.zeros(groups * _GROUP, dtype=np.uint64)
+    x[: data.size] = data.astype(np.int64) & _MASK
+    x = x.reshape(-1, _GROUP)
+    word = x[:, 0] | (x[:, 1] << 14) | (x[:, 2] << 28) | (x[:, 3] << 42)
+    out = word.astype("<u8").view(np.uint8).reshape(-1, 8)
+    return np.ascontiguousarray(out[:, :_GROUP_BYTES]).ravel()
+
+
+def unpack14(buff, count):
+    """Unpack count 14-bit samples to sign extended int16."""
+    buff = np.frombuffer(buff, dtype=np.uint8)
+    groups = -(-count // _GROUP)
+    if buff.size < groups * _GROUP_BYTES:
+        raise ValueError("Error: packed buffer too short")
+    words = np.zeros((groups, 8), dtype=np.uint8)
+    words[:, :_GROUP_BYTES] = buff[: groups * _GROUP_BYTES].reshape(-1, _GROUP_BYTES)
+    word = words.view("<u8")
+    shifts = np.array([0, 14, 28, 42], dtype=np.uint64)
+    return _sign_extend((word >> shifts) & _MASK).ravel()[:count]
+
+
+def delta_encode(data, num_ch=1):
+    """Delta encode interleaved 14-bit samples.
+
+    Each sample is replaced by its 14-bit wrapped difference to the previous
+    sample of the same channel, zigzag mapped, and blocks of 64 values are
+    bit packed at the width of the largest value in the block, LSB first.
+    """
+    x = np.asarray(data).ravel().astype(np.int32)
+    prev = np.zeros_like(x)
+    prev[num_ch:] = x[:-num_ch] if x.size > num_ch else prev[num_ch:]
+    delta = (((x - prev) & _MASK) ^ _SIGN) - _SIGN
+    zz = ((delta << 1) ^ (delta >> 31)) & _MASK
+
+    blocks = -(-x.size // _DELTA_BLOCK)
+    z = np.zeros(blocks * _DELTA_BLOCK, dtype=np.uint16)
+    z[: x.size] = zz
+    z = z.reshape(-1, _DELTA_BLOCK)
+
+    top = np.bitwise_or.reduce(z, axis=1)
+    widths = np.zeros(blocks, dtype=np.uint8)
+    for bit in range(_DELTA_MAX_WIDTH):
+        widths += (top >> bit) > 0
+
+    sizes = 1 + 8 * widths.astype(np.int64)
+    offsets = np.cumsum(sizes) - sizes
+    out = np.empty(int(sizes.sum()), dtype=np.uint8)
+    out[offsets] = widths
+    for w in np.unique(widths[widths > 0]):
+        idx = np.flatnonzero(widths == w)
+        bits = (z[idx, :, None] >> np.arange(w, dtype=np.uint16)) & 1
+        packed = np.packbits(
+            bits.reshape(idx.size, -1).astype(np.uint8), axis=1, bitorder="little"
+        )
+        out[offsets[idx, None] + 1 + np.arange(8 * w)] = packed
+    return out
+
+
+def delta_decode(buff, count, num_ch=1):
+    """Decode count delta encoded samples to sign extended int16."""
+    buff = np.frombuffer(buff, dtype=np.uint8)
+    blocks = -(-count // _DELTA_BLOCK)
+    widths = np.empty(blocks, dtype=np.int64)
+    offsets = np.empty(blocks, dtype=np.int64)
+    pos = 0
+    for i in range(blocks):
+        if pos >= buff.size or buff[pos] > _DELTA_MAX_WIDTH:
+            raise ValueError("Error: corrupted delta stream")
+        widths[i] = buff[pos]
+        offsets[i] = pos
+        pos += 1 + 8 * int(buff[pos])
+    if pos > buff.size:
+        raise ValueError("Error: corrupted delta stream")
+
+    z = np.zeros((blocks, _DELTA_BLOCK), dtype=np.int32)
+    for w in np.unique(widths[widths > 0]):
+        idx = np.flatnonzero(widths == w)
+        packed = buff[offsets[idx, None] + 1 + np.arange(8 * w)]
+        bits = np.unpackbits(packed, axis=1, bitorder="little")
+        bits = bits.reshape(idx.size, _DELTA_BLOCK, w).astype(np.int32)
+        z[idx] = (bits << np.arange(w, dtype=np.int32)).sum(axis=2)
+
+    delta = (z.ravel()[:count] >> 1) ^ -(z.ravel()[:count] & 1)
+    frames = -(-count // num_ch)
+    acc = np.zeros(frames * num_ch, dtype=np.int64)
+    acc[:count] = delta
+    acc = np.cumsum(acc.reshape(frames, num_ch), axis=0).ravel()[:count]
+    return _sign_extend(acc & _MASK)
+
+
+def encode(data, fmt="delta", num_ch=1):
+    """Encode interleaved samples in one of FORMATS, returns uint8 array."""
+    if fmt not in FORMATS:
+        raise ValueError("Error: Format not supported \nUse one of: " + str(FORMATS))
+    if fmt == "packed14":
+        return pack14(data)
+    if fmt == "delta":
+        return delta_encode(data, num_ch)
+    return np.asarray(data, dtype="<i2").ravel().view(np.uint8).copy()
+
+
+def decode(buff, count, fmt="delta", num_ch=1):
+    """Decode count interleaved samples encoded in one of FORMATS."""
+    if fmt not in FORMATS:
+        raise ValueError("Error: Format not supported \nUse one of: " + str(FORMATS))
+    if fmt == "packed14":
+        return unpack14(buff, count)
+    if fmt == "delta":
+        return delta_decode(buff, count, num_ch)
+    return np.frombuffer(buff, dtype="<i2", count=count).astype(np.int16)
+
+
+def _interleave(data):
+    if isinstance(data, (list, tuple)):
+        return np.stack([np.asarray(ch) for ch in data], axis=1).ravel(), len(data)
+    return np.asarray(data).ravel(), 1
+
+
+def save(filename, data, fmt="delta"):
+    """Store a capture in the packed container format.
+
+    data is either a single channel array or a list of channel arrays as
+    returned by adaq8092.rx(). Files are interchangeable with the no-OS
+    adaq8092_pack module.
+    """
+    data, num_ch = _interleave(data)
+    payload = encode(data, fmt, num_ch)
+    with open(filename, "wb") as f:
+        f.write(
+            _HDR.pack(
+                _MAGIC, _VERSION, FORMATS[fmt], num_ch, 0, data.size, payload.size
+            )
+        )
+        f.write(payload.tobytes())
+
+
+def load(filename):
+    """Load a capture stored with save(), in the same layout as rx()."""
+    with open(filename, "rb") as f:
+        hdr = f.read(_HDR.size)
+        if len(hdr) != _HDR.size:
+            raise ValueError("Error: not an ADAQ8092 capture file")
+        magic, version, fmt, num_ch, _, count, size = _HDR.unpack(hdr)
+        if magic != _MAGIC or version != _VERSION or fmt >= len(FORMATS) or not num_ch:
+            raise ValueError("Error: not an ADAQ8092 capture file")
+        payload = f.read(size)
+
+    name = [k for k, v in FORMATS.items() if v == fmt][0]
+    data = decode(payload, count, name, num_ch)
+    if num_ch == 1:
+        return data
+    return [data[ch::num_ch].copy() for ch in range(num_ch)]
+
+
+def benchmark(data, repeat=5):
+    """Measure compression ratio and throughput of every format.
+
+    Returns a dict keyed by format with the ratio against 16-bit storage and
+    the encode/decode rates in MB/s of 16-bit input.
+    """
+    data, num_ch = _interleave(data)
+    mbytes = data.size * 2 / 1e6
+    results = {}
+    for fmt in FORMATS:
+        enc = dec = float("inf")
+        for _ in range(repeat):
+            start = time.perf_counter()
+            payload = encode(data, fmt, num_ch)
+            enc = min(enc, time.perf_counter() - start)
+            start = time.perf_counter()
+            out = decode(payload, data.size, fmt, num_ch)
+            dec = min(dec, time.perf_counter() - start)
+        ref = data if fmt == "raw16" else _sign_extend(data.astype(np.int64) & _MASK)
+        if not np.array_equal(out, ref):
+            raise RuntimeError("Error: " + fmt + " round trip mismatch")
+        results[fmt] = {
+            "ratio": data.size * 2 / payload.size,
+            "encode_mbps": mbytes / enc,
+            "decode_mbps": mbytes / dec,
+        }
+    return results
@@ -0,0 +1,77 @@
+# Copyright (C) 2022 Analog Devices, Inc.
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#     - Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     - Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in
+#       the documentation and/or other materials provided with the
+#       distribution.
+#     - Neither the name of Analog Devices, Inc. nor the names of its
+#       contributors may be used to endorse or promote products derived
+#       from this software without specific prior written permission.
+#     - The use of this software may or may not infringe the patent rights
+#       of one or more patent holders.  This license does not release you
+#       from the requirement that you obtain separate licenses from these
+#       patent holders to use this software.
+#     - Use of the software either in source or binary form, must be run
+#       on or directly connected to an Analog Devices Inc. component.
+#
+# THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+# INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+# PARTICULAR PURPOSE ARE DISCLAIMED.
+#
+# IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, INTELLECTUAL PROPERTY
+# RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+# BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+# STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+# THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+import sys
+
+import numpy as np
+from adi import adaq8092
+from adi.adaq8092_pack import benchmark
+
+# Optionally passs URI as command line argument,
+# else only the synthetic test patterns are benchmarked
+my_uri = sys.argv[1] if len(sys.argv) >= 2 else None
+
+n = 1 << 20
+t = np.arange(n // 2)
+rng = np.random.default_rng()
+tone = 4000 * np.sin(2 * np.pi * 1e6 / 105e6 * t)
+patterns = {
+    "checkerboard": np.full(n, 0x1555, dtype=np.int16),
+    "alternating": np.tile(np.array([0x1555, -0x1556], dtype=np.int16), n // 2),
+    "sine + noise": [
+        np.round(tone + 3 * rng.standard_normal(t.size)).astype(np.int16),
+        np.round(tone[::-1] + 3 * rng.standard_normal(t.size)).astype(np.int16),
+    ],
+}
+
+if my_uri:
+    print("uri: " + str(my_uri))
+    my_adc = adaq8092(uri=my_uri)
+    my_adc.rx_buffer_size = n // 2
+    my_adc.rx_output_type = "raw"
+    my_adc.rx_decode = True
+    patterns["capture"] = my_adc.rx()
+    del my_adc
+
+print(
+    "{:<14}{:<10}{:>8}{:>14}{:>14}".format(
+        "data", "format", "ratio", "enc MB/s", "dec MB/s"
+    )
+)
+for name, data in patterns.items():
+    for fmt, res in benchmark(data).items():
+        print(
+            "{:<14}{:<10}{:>8.3f}{:>14.1f}{:>14.1f}".format(
+                name, fmt, res["ratio"], res["encode_mbps"], res["decode_mbps"]
+            )
+        )
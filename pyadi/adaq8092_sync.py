@@ -0,0 +1,89 @@
+# Copyright (C) 2022 Analog Devices, Inc.
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#     - Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     - Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in
+#       the documentation and/or other materials provided with the
+#       distribution.
+#     - Neither the name of Analog Devices, Inc. nor the names of its
+#       contributors may be used to endorse or promote products derived
+#       from this software without specific prior written permission.
+#     - The use of this software may or may not infringe the patent rights
+#       of one or more patent holders.  This license does not release you
+#       from the requirement that you obtain separate licenses from these
+#       patent holders to use this software.
+#     - Use of the software either in source or binary form, must be run
+#       on or directly connected to an Analog Devices Inc. component.
+#
+# THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+# INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+# PARTICULAR PURPOSE ARE DISCLAIMED.
+#
+# IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, INTELLECTUAL PROPERTY
+# RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+# BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+# STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+# THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Alignment and merging of captures from several ADAQ8092 boards
+
+Mirrors adaq8092_sync_align()/adaq8092_sync_merge() from the no-OS driver.
+Every board must see the same rising edge (a shared step or trigger pulse) on
+the reference channel; the edge position gives each board's sample offset.
+"""
+
+import numpy as np
+
+
+def find_edge(data, threshold):
+    """Index of the first rising crossing of threshold, None if there is none."""
+    data = np.asarray(data)
+    idx = np.flatnonzero((data[:-1] < threshold) & (data[1:] >= threshold))
+    return int(idx[0]) + 1 if idx.size else None
+
+
+def find_offsets(captures, ref_ch=0, threshold=0):
+    """Sample offset of every board relative to the first one.
+
+    captures is a list with one entry per board, each a list of channel
+    arrays as returned by adaq8092.rx().
+    """
+    edges = [find_edge(board[ref_ch], threshold) for board in captures]
+    if None in edges:
+        raise ValueError(
+            "No alignment edge on board %d" % edges.index(None)
+        )
+    return [edge - edges[0] for edge in edges]
+
+
+def merge(captures, offsets):
+    """Stack the aligned channels of all boards into one array.
+
+    Rows are the channels of board 0 followed by those of board 1 and so on,
+    trimmed to the span every board captured.
+    """
+    start = [off - min(offsets) for off in offsets]
+    length = min(len(ch) for board in captures for ch in board) - (
+        max(offsets) - min(offsets)
+    )
+    if length <= 0:
+        raise ValueError("Board offsets exceed the capture length")
+    return np.stack(
+        [
+            np.asarray(ch)[s : s + length]
+            for board, s in zip(captures, start)
+            for ch in board
+        ]
+    )
+
+
+def align(captures, ref_ch=0, threshold=0):
+    """Align captures on the shared edge and merge them, see merge()."""
+    offsets = find_offsets(captures, ref_ch, threshold)
+    return merge(captures, offsets), offsets
@@ -0,0 +1,208 @@
+# Copyright (C) 2022 Analog Devices, Inc.
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#     - Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     - Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in
+#       the documentation and/or other materials provided with the
+#       distribution.
+#     - Neither the name of Analog Devices, Inc. nor the names of its
+#       contributors may be used to endorse or promote products derived
+#       from this software without specific prior written permission.
+#     - The use of this software may or may not infringe the patent rights
+#       of one or more patent holders.  This license does not release you
+#       from the requirement that you obtain separate licenses from these
+#       patent holders to use this software.
+#     - Use of the software either in source or binary form, must be run
+#       on or directly connected to an Analog Devices Inc. component.
+#
+# THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+# INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+# PARTICULAR PURPOSE ARE DISCLAIMED.
+#
+# IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, INTELLECTUAL PROPERTY
+# RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+# BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+# STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+# THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Host receiver for the no-OS binary framed UART stream (adaq8092_stream)
+
+Frames are resynchronized on the sync word, checked with their CRC and
+reassembled in sequence order into per channel arrays, which are stored as
+.npy or as raw interleaved little endian int16.
+
+usage: python adaq8092_uart_receiver.py /dev/ttyUSB0 capture.npy -b 921600
+"""
+
+import argparse
+import binascii
+import struct
+import sys
+
+import numpy as np
+
+try:
+    from adi.adaq8092_pack import FORMATS, decode, encode
+except ImportError:
+    from adaq8092_pack import FORMATS, decode, encode
+
+SYNC = 0x92A8
+_HDR = struct.Struct("<HHBBHH")
+_CRC = struct.Struct("<H")
+MAX_SAMPLES = 1024
+
+_FORMAT_NAMES = {v: k for k, v in FORMATS.items()}
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, as computed by adaq8092_stream_crc16()."""
+    return binascii.crc_hqx(bytes(data), crc)
+
+
+def _num_ch(ch_mask):
+    return bin(ch_mask & 0x3).count("1")
+
+
+def encode_frame(seq, ch_mask, fmt, data):
+    """Build one frame from interleaved samples, same layout as the no-OS side."""
+    data = np.asarray(data, dtype=np.int16).ravel()
+    payload = encode(data, fmt, _num_ch(ch_mask)).tobytes()
+    frame = (
+        _HDR.pack(
+            SYNC, seq & 0xFFFF, ch_mask, FORMATS[fmt], data.size, len(payload)
+        )
+        + payload
+    )
+    return frame + _CRC.pack(crc16(frame))
+
+
+class frame_parser:
+
+    """Incremental frame parser
+
+    Bytes are fed as they arrive; complete, valid frames are returned as
+    (seq, ch_mask, samples) tuples. Corrupted frames are dropped and counted,
+    and sequence gaps are accounted as lost frames.
+    """
+
+    def __init__(self):
+        self._buff = bytearray()
+        self._next_seq = None
+        self.frames = 0
+        self.crc_errors = 0
+        self.lost_frames = 0
+
+    def feed(self, data):
+        """Parse data and return the list of frames it completed."""
+        self._buff += data
+        out = []
+        sync = struct.pack("<H", SYNC)
+        while True:
+            start = self._buff.find(sync)
+            if start < 0:
+                del self._buff[: max(len(self._buff) - 1, 0)]
+                return out
+            del self._buff[:start]
+            if len(self._buff) < _HDR.size:
+                return out
+
+            _, seq, ch_mask, fmt, count, length = _HDR.unpack_from(self._buff)
+            if (
+                fmt not in _FORMAT_NAMES
+                or not _num_ch(ch_mask)
+                or count > MAX_SAMPLES
+                or length > 2 * MAX_SAMPLES
+            ):
+                del self._buff[:1]
+                continue
+
+            size = _HDR.size + length + _CRC.size
+            if len(self._buff) < size:
+                return out
+
+            frame = bytes(self._buff[:size])
+            if crc16(frame[: -_CRC.size]) != _CRC.unpack_from(frame, size - 2)[0]:
+                self.crc_errors += 1
+                del self._buff[:1]
+                continue
+            del self._buff[:size]
+
+            if self._next_seq is not None:
+                self.lost_frames += (seq - self._next_seq) & 0xFFFF
+            self._next_seq = (seq + 1) & 0xFFFF
+            self.frames += 1
+
+            samples = decode(
+                frame[_HDR.size : -_CRC.size],
+                count,
+                _FORMAT_NAMES[fmt],
+                _num_ch(ch_mask),
+            )
+            out.append((seq, ch_mask, samples))
+
+
+def receive(port, baudrate=921600, samples=None, timeout=2.0):
+    """Read frames from a serial port until samples are collected or it idles.
+
+    Returns the interleaved int16 samples, the channel mask and the parser
+    holding the error counters.
+    """
+    import serial
+
+    parser = frame_parser()
+    chunks = []
+    ch_mask = 0
+    total = 0
+    with serial.Serial(port, baudrate, timeout=timeout) as ser:
+        while samples is None or total < samples:
+            data = ser.read(max(ser.in_waiting, 1))
+            if not data:
+                break
+            for _, mask, frame in parser.feed(data):
+                ch_mask = mask
+                chunks.append(frame)
+                total += frame.size
+
+    data = np.concatenate(chunks) if chunks else np.zeros(0, dtype=np.int16)
+    return data, ch_mask, parser
+
+
+def save(filename, data, ch_mask):
+    """Store interleaved samples, .npy as (channels, samples), else raw int16."""
+    if filename.endswith(".npy"):
+        num_ch = max(_num_ch(ch_mask), 1)
+        data = data[: data.size - data.size % num_ch]
+        np.save(filename, data.reshape(-1, num_ch).T)
+    else:
+        data.astype("<i2").tofile(filename)
+
+
+def main(argv=None):
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("port", help="serial port, e.g. /dev/ttyUSB0 or COM3")
+    ap.add_argument("output", help="output file, .npy or raw interleaved int16")
+    ap.add_argument("-b", "--baudrate", type=int, default=921600)
+    ap.add_argument("-n", "--samples", type=int, default=None)
+    ap.add_argument("-t", "--timeout", type=float, default=2.0)
+    args = ap.parse_args(argv)
+
+    data, ch_mask, parser = receive(
+        args.port, args.baudrate, args.samples, args.timeout
+    )
+    save(args.output, data, ch_mask)
+    print(
+        "{} samples in {} frames, {} CRC errors, {} lost frames".format(
+            data.size, parser.frames, parser.crc_errors, parser.lost_frames
+        )
+    )
+    return 0 if not (parser.crc_errors or parser.lost_frames) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,4 +1,13 @@
+import numpy as np
 import pytest
+from adi.adaq8092 import adaq8092, decode
+from adi.adaq8092_analysis import dynamic_analyzer
+from adi.adaq8092_benchmark import bench_deinterleave, check_thresholds
+from adi.adaq8092_emu import adaq8092_emu, emulated_adaq8092
+from adi.adaq8092_group import adaq8092_group
+from adi.adaq8092_pack import load, save
+from adi.adaq8092_sync import align
+from adi.adaq8092_uart_receiver import encode_frame, frame_parser
 
 hardware = ["adaq8092"]
 classname = "adi.adaq8092"
@@ -61,3 +70,355 @@ def test_adaq8092_rx_data(test_dma_rx, iio_uri, classname, channel):
 )
 def test_ad4630_attr(test_attribute_multipe_values, iio_uri, classname, attr, val):
     test_attribute_multipe_values(iio_uri, classname, attr, val, 0)
+
+
+#########################################
+@pytest.mark.parametrize("window", ["hann", "blackmanharris"])
+def test_adaq8092_dynamic_analyzer(window):
+    rng = np.random.default_rng(0)
+    t = np.arange(1 << 17)
+    amp, sigma, hd3 = 4000, 2, 3
+    tone = 2 * np.pi * 101 / 4096 * t
+    data = amp * np.sin(tone) + hd3 * np.sin(3 * tone)
+    data += sigma * rng.standard_normal(t.size)
+
+    analyzer = dynamic_analyzer(fft_size=4096, window=window)
+    for block in np.split(data, 16):
+        analyzer.update([block, block])
+
+    assert analyzer.averages == (t.size - 4096) // 2048 + 1
+    for res in analyzer.metrics():
+        snr = 10 * np.log10(amp ** 2 / 2 / sigma ** 2)
+        assert res["snr"] == pytest.approx(snr, abs=0.5)
+        assert res["thd"] == pytest.approx(20 * np.log10(hd3 / amp), abs=0.5)
+        assert res["sfdr"] == pytest.approx(20 * np.log10(amp / hd3), abs=1)
+
+
+#########################################
+@pytest.mark.parametrize("alt_bit_pol", [False, True])
+@pytest.mark.parametrize("data_rand", [False, True])
+@pytest.mark.parametrize("twos_complement", [False, True])
+def test_adaq8092_decode(alt_bit_pol, data_rand, twos_complement):
+    codes = np.arange(-8192, 8192, dtype=np.int16)
+    raw = codes.astype(np.uint16) & 0x3FFF
+    if not twos_complement:
+        raw ^= 0x2000
+    if data_rand:
+        raw ^= (raw & 1) * np.uint16(0x3FFE)
+    if alt_bit_pol:
+        raw ^= 0x2AAA
+
+    out = decode(raw, alt_bit_pol, data_rand, twos_complement)
+    assert out.dtype == np.int16
+    np.testing.assert_array_equal(out, codes)
+
+
+#########################################
+@pytest.mark.parametrize("fmt", ["raw16", "packed14", "delta"])
+@pytest.mark.parametrize("length", [1, 63, 1000, 4099])
+def test_adaq8092_pack(tmp_path, fmt, length):
+    rng = np.random.default_rng(length)
+    codes = rng.integers(-8192, 8192, size=(2, length), dtype=np.int16)
+    codes[0] = np.cumsum(codes[0] % 16 - 8).astype(np.int16)
+    codes[:, 0] = [-8192, 8191]
+
+    save(tmp_path / "capture.bin", list(codes), fmt)
+    out = load(tmp_path / "capture.bin")
+    assert len(out) == 2
+    for ch in range(2):
+        assert out[ch].dtype == np.int16
+        np.testing.assert_array_equal(out[ch], codes[ch])
+
+
+#########################################
+@pytest.mark.parametrize("fmt", ["raw16", "packed14", "delta"])
+def test_adaq8092_uart_frames(fmt):
+    codes = np.arange(-8192, 8192, 4, dtype=np.int16)
+    frames = [
+        encode_frame(seq, 0x3, fmt, codes[i : i + 1024])
+        for seq, i in enumerate(range(0, codes.size, 1024))
+    ]
+    corrupt = bytearray(frames[1])
+    corrupt[20] ^= 0xFF
+    stream = b"boot log\n" + frames[0] + bytes(corrupt) + b"".join(frames[2:])
+
+    parser = frame_parser()
+    out = []
+    for i in range(0, len(stream), 100):
+        out += parser.feed(stream[i : i + 100])
+
+    assert [seq for seq, _, _ in out] == [0, 2, 3]
+    assert parser.crc_errors == 1
+    assert parser.lost_frames == 1
+    expected = np.concatenate([codes[:1024], codes[2048:]])
+    np.testing.assert_array_equal(np.concatenate([f for _, _, f in out]), expected)
+
+
+def test_adaq8092_sync_align():
+    t = np.arange(1000)
+    edges = [400, 371, 452, 400]
+    captures = [
+        [(t - edge + 5000 * board).astype(np.int16), np.where(t >= edge, 2000, 0)]
+        for board, edge in enumerate(edges)
+    ]
+
+    merged, offsets = align(captures, ref_ch=1, threshold=1000)
+    assert offsets == [0, -29, 52, 0]
+    assert merged.shape == (8, 1000 - 81)
+    for board in range(4):
+        np.testing.assert_array_equal(
+            merged[2 * board] - merged[0], np.full(919, 5000 * board)
+        )
+        assert merged[2 * board + 1, 371] == 2000
+        assert merged[2 * board + 1, 370] == 0
+
+
+def test_adaq8092_group():
+    class fake_device:
+        rx_buffer_size = 0
+        rx_enabled_channels = [0, 1]
+
+        def __init__(self, uri):
+            self.edge = int(uri)
+
+        def rx(self):
+            t = np.arange(self.rx_buffer_size)
+            data = [t - self.edge, np.where(t >= self.edge, 2000, 0)]
+            data = [data[ch] for ch in self.rx_enabled_channels]
+            return data if len(data) > 1 else data[0]
+
+    uris = ["100", "90", "130"]
+    with adaq8092_group(uris, device=fake_device) as group:
+        group.rx_buffer_size = 500
+        assert group.get_attr("rx_buffer_size") == [500] * 3
+        assert group.rx().shape == (6, 500)
+
+        group.ref_ch = 1
+        group.threshold = 1000
+        merged = group.rx()
+        assert group.offsets == [0, -10, 30]
+        assert merged.shape == (6, 460)
+        np.testing.assert_array_equal(merged[0::2], np.tile(merged[0], (3, 1)))
+
+        # ref_ch is a channel number, not an index into the enabled channels
+        group.set_attr("rx_enabled_channels", [1])
+        merged = group.rx()
+        assert group.offsets == [0, -10, 30]
+        assert merged.shape == (3, 460)
+
+        group.ref_ch = 0
+        with pytest.raises(ValueError):
+            group.rx()
+
+
+def test_adaq8092_emu():
+    import socket
+    import xml.etree.ElementTree as ET
+
+    with adaq8092_emu(signal="ramp", noise=0) as emu:
+        sock = socket.create_connection(emu.address)
+        rfile = sock.makefile("rb")
+
+        def cmd(line, data=b""):
+            sock.sendall(line.encode() + b"\r\n" + data)
+            return int(rfile.readline())
+
+        assert cmd("PRINT") > 0
+        dev = ET.fromstring(rfile.readline()).find("device")
+        assert dev.get("name") == "adaq8092"
+        assert [ch.get("id") for ch in dev.iter("channel")] == ["voltage0", "voltage1"]
+        attrs = [attr.get("name") for attr in dev.iter("attribute")]
+        assert "test_mode_available" in attrs and "reconfig_count" in attrs
+
+        assert cmd("WRITE iio:device0 test_mode 7", b"invalid") == -22
+        assert cmd("WRITE iio:device0 test_mode 17", b"test_checkerboard") == 17
+        assert cmd("READ iio:device0 reconfig_count") == 1
+        assert rfile.readline() == b"1\n"
+
+        emu.device.link_errors[1] = 3
+        assert cmd("READ iio:device0 INPUT voltage1 link_errors") == 1
+        assert rfile.readline() == b"3\n"
+        assert cmd("WRITE iio:device0 INPUT voltage1 link_errors 1", b"0") == -13
+
+        assert cmd("OPEN iio:device0 8 00000003") == 0
+        assert cmd("READBUF iio:device0 32") == 32
+        assert rfile.readline() == b"00000003\n"
+        data = np.frombuffer(rfile.read(32), dtype="<i2").reshape(-1, 2)
+        np.testing.assert_array_equal(data[:, 0], [0x2AAA - 0x4000, 0x1555] * 4)
+
+        cmd("WRITE iio:device0 test_mode 16", b"test_pattern_off")
+        assert cmd("READBUF iio:device0 16") == 16
+        rfile.readline()
+        data = np.frombuffer(rfile.read(16), dtype="<i2")
+        np.testing.assert_array_equal(data[0::2], np.arange(8, 12) - 0x2000)
+        sock.close()
+
+
+@pytest.mark.parametrize("amplitude, expected", [(4000, 0), (9000, 2)])
+def test_adaq8092_emu_over_range(amplitude, expected):
+    # One sine period split over two reads, CH1 saturates once per half wave
+    emu = emulated_adaq8092(amplitude=amplitude, frequency=1.05e6, noise=0)
+    emu.samples(40)
+    emu.samples(60)
+    assert emu.read_chan_attr(0, "over_range_count") == str(expected)
+    assert emu.write_chan_attr(0, "over_range_count", "0") == -13
+
+
+def test_adaq8092_benchmark_thresholds():
+    results = bench_deinterleave(sizes=[1024, 4096], repeat=2)
+    assert sorted(results) == [
+        "deinterleave_ns_per_sample/1024",
+        "deinterleave_ns_per_sample/4096",
+    ]
+
+    results["rx_msps/1024"] = 20.0
+    thresholds = {
+        "deinterleave_ns_per_sample/1024": {"max": 1e6},
+        "rx_msps/1024": {"min": 50.0, "max": 100.0},
+        "latency_us/rx": {"max": 1.0},
+    }
+    assert check_thresholds(results, thresholds) == [
+        "latency_us/rx: not measured",
+        "rx_msps/1024: 20.000 below 50.000",
+    ]
+
+
+def test_adaq8092_rx_mark_reconfig(monkeypatch):
+    class fake_core(adaq8092):
+        rx_output_type = "raw"
+        reconfig_count = 0
+
+    monkeypatch.setattr("adi.adaq8092.rx.rx", lambda self: [np.zeros(16, np.int16)])
+    monkeypatch.setattr(
+        "adi.adaq8092.rx.rx_destroy_buffer", lambda self: None, raising=False
+    )
+    dev = fake_core.__new__(fake_core)
+    dev.rx_mark_reconfig = True
+
+    dev.rx()
+    assert not dev.rx_reconfigured
+    # Changed between two calls, the queued blocks span it
+    dev.reconfig_count = 1
+    dev.rx()
+    assert dev.rx_reconfigured
+    dev.rx()
+    assert not dev.rx_reconfigured
+
+    # A new buffer holds nothing from before it was created
+    dev.reconfig_count = 2
+    dev.rx_destroy_buffer()
+    dev.rx()
+    assert not dev.rx_reconfigured
+
+
+def test_adaq8092_rx_decode_mode_cached(monkeypatch):
+    attrs = {
+        "alt_bit_pol_en": "alternate_bit_polarity_off",
+        "alt_bit_pol_en_available": "alternate_bit_polarity_off alternate_bit_polarity_on",
+        "data_rand_en": "data_randomizer_off",
+    }
+    reads = []
+
+    class fake_core(adaq8092):
+        rx_output_type = "raw"
+        reconfig_count = 0
+
+        def _get_iio_dev_attr_str(self, attr):
+            reads.append(attr)
+            return attrs[attr]
+
+        def _set_iio_dev_attr_str(self, attr, value):
+            attrs[attr] = value
+
+    monkeypatch.setattr("adi.adaq8092.rx.rx", lambda self: [np.zeros(16, np.int16)])
+    dev = fake_core.__new__(fake_core)
+    dev.rx_decode = True
+
+    dev.rx()
+    dev.rx()
+    assert len(reads) == 2
+    # Re-read once after a reconfiguration
+    dev.reconfig_count = 1
+    dev.rx()
+    dev.rx()
+    assert len(reads) == 4
+    # and after a mode change made through the class
+    dev.alt_bit_pol_en = "alternate_bit_polarity_on"
+    del reads[:]
+    dev.rx()
+    dev.rx()
+    assert reads == ["alt_bit_pol_en", "data_rand_en"]
+
+
+@pytest.mark.parametrize("scale", ["0.122070312", "0.061035156"])
+def test_adaq8092_to_volts(scale):
+    # The driver reports offset 0 whatever the output format
+    attrs = {"scale": scale, "offset": "0"}
+    dev = adaq8092.__new__(adaq8092)
+    dev._rx_channel_names = ["voltage0", "voltage1"]
+    dev._get_iio_attr_str = lambda name, attr, output: attrs[attr]
+
+    raw = np.arange(-8192, 8192, dtype=np.int16)
+    volts = dev.to_volts([raw, raw[::-1].copy()], [0, 1])
+    assert volts[0].dtype == np.float32
+    np.testing.assert_allclose(volts[0], raw * float(scale) / 1000, atol=1e-6)
+    np.testing.assert_allclose(volts[1], volts[0][::-1])
+
+    # Blocks of the same size are written to the same arrays
+    again = dev.to_volts([raw, raw], [0, 1])
+    assert again[0] is volts[0]
+
+
+def test_adaq8092_calibration(tmp_path):
+    class fake_core(adaq8092):
+        rx_enabled_channels = [0, 1]
+        rx_output_type = "raw"
+        level = [0.0, 0.0]
+
+        def _get_iio_attr_str(self, name, attr, output):
+            return self.attrs[name][attr]
+
+        def _set_iio_attr_str(self, name, attr, output, value):
+            self.attrs[name][attr] = value
+
+        def rx_destroy_buffer(self):
+            pass
+
+        # Stands in for the whole capture path, no IIO context behind it
+        def rx(self):
+            out = []
+            for ch, name in enumerate(self._rx_channel_names):
+                attrs = self.attrs[name]
+                code = self.level[ch] / 0.122070312e-3 * [1.02, 0.97][ch]
+                code += [37, -12][ch]
+                code = (code + int(attrs["calibbias"])) * float(attrs["calibscale"])
+                out.append(np.full(4096, np.round(code), dtype=np.int16))
+            return out
+
+    dev = fake_core.__new__(fake_core)
+    dev._rx_channel_names = ["voltage0", "voltage1"]
+    dev.attrs = {
+        name: {
+            "calibbias": "0",
+            "calibscale": "1.0",
+            "scale": "0.122070312",
+            "offset": "0",
+        }
+        for name in dev._rx_channel_names
+    }
+
+    cal = dev.calibrate_offset(samples=8192)
+    assert [cal[name]["calibbias"] for name in cal] == [-37, 12]
+
+    dev.level = [0.9, 0.9]
+    cal = dev.calibrate_gain(0.9, samples=8192)
+    for ch, name in enumerate(dev._rx_channel_names):
+        gain = [1.02, 0.97][ch]
+        assert cal[name]["calibscale"] == pytest.approx(1 / gain, abs=1e-3)
+        assert np.mean(dev.rx()[ch]) == pytest.approx(0.9 / 0.122070312e-3, abs=2)
+
+    dev.save_calibration(tmp_path / "cal.json")
+    for name in dev._rx_channel_names:
+        dev.attrs[name].update(calibbias="0", calibscale="1.0")
+    dev.load_calibration(tmp_path / "cal.json")
+    assert dev.get_calibration() == cal